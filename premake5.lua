@@ -9,6 +9,17 @@ workspace "shado-opengl-api"
 		"Dist"
 	}
 
+	-- Shipped games don't need the per-vertex entity IDs the editor uses for mouse picking
+	filter "options:runtime"
+		defines "SHADO_EDITOR_DATA=0"
+	filter {}
+
+newoption
+{
+	trigger = "runtime",
+	description = "Build without editor-only render data (entity IDs in Renderer2D vertices and shaders)"
+}
+
 outputdir = "%{cfg.buildcfg}-%{cfg.system}-%{cfg.architecture}"
 
 -- Include deirectories relative to root folder
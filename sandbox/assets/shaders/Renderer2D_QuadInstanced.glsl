@@ -0,0 +1,76 @@
+// Instanced quads. Every instance is one quad, the corners are expanded from gl_VertexID
+#type vertex
+#version 450 core
+
+layout(location = 0) in vec4 a_Transform;
+layout(location = 1) in vec3 a_Translation;
+layout(location = 2) in int a_Color;
+layout(location = 3) in vec4 a_TexRect;
+layout(location = 4) in int a_TexIndex;
+#if SHADO_EDITOR_DATA
+layout(location = 5) in int a_EntityID;
+#endif
+
+layout(std140, binding = 0) uniform Camera
+{
+	mat4 u_ViewProjection;
+};
+
+struct VertexOutput
+{
+	vec4 Color;
+	vec2 TexCoord;
+};
+
+layout (location = 0) out VertexOutput Output;
+layout (location = 2) out flat int v_TexIndex;
+#if SHADO_EDITOR_DATA
+layout (location = 3) out flat int v_EntityID;
+#endif
+
+const vec2 c_Corners[4] = vec2[](vec2(-0.5, -0.5), vec2(0.5, -0.5), vec2(0.5, 0.5), vec2(-0.5, 0.5));
+const vec2 c_TexCoords[4] = vec2[](vec2(0.0, 0.0), vec2(1.0, 0.0), vec2(1.0, 1.0), vec2(0.0, 1.0));
+
+void main()
+{
+	vec2 position = mat2(a_Transform.xy, a_Transform.zw) * c_Corners[gl_VertexID] + a_Translation.xy;
+
+	Output.Color = unpackUnorm4x8(uint(a_Color));
+	Output.TexCoord = mix(a_TexRect.xy, a_TexRect.zw, c_TexCoords[gl_VertexID]);
+	v_TexIndex = a_TexIndex;
+#if SHADO_EDITOR_DATA
+	v_EntityID = a_EntityID;
+#endif
+
+	gl_Position = u_ViewProjection * vec4(position, a_Translation.z, 1.0);
+}
+
+#type fragment
+#version 450 core
+
+layout(location = 0) out vec4 o_Color;
+#if SHADO_EDITOR_DATA
+layout(location = 1) out int o_EntityID;
+#endif
+
+struct VertexOutput
+{
+	vec4 Color;
+	vec2 TexCoord;
+};
+
+layout (location = 0) in VertexOutput Input;
+layout (location = 2) in flat int v_TexIndex;
+#if SHADO_EDITOR_DATA
+layout (location = 3) in flat int v_EntityID;
+#endif
+
+layout (binding = 0) uniform sampler2D u_Textures[32];
+
+void main()
+{
+	o_Color = Input.Color * texture(u_Textures[v_TexIndex], Input.TexCoord);
+#if SHADO_EDITOR_DATA
+	o_EntityID = v_EntityID;
+#endif
+}
@@ -0,0 +1,200 @@
+#include "Benchmarks.h"
+
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "Shado.h"
+
+namespace Shado::Benchmarks {
+	// Prevents the compiler from optimizing away the measured work
+	static volatile uint64_t s_Sink = 0;
+
+	void RunAll() {
+		SceneEntityLookup();
+
+		Application::get();
+		InstancedQuads();
+		ParallelSpriteRecording();
+		TexturedQuads();
+	}
+
+	void SceneEntityLookup() {
+		std::cout << "[Scene::getEntityById]" << std::endl;
+
+		constexpr uint32_t lookups = 100000;
+		for (uint32_t entityCount = 1000; entityCount <= 1000000; entityCount *= 10) {
+			Scene scene;
+			std::vector<UUID> ids;
+			ids.reserve(entityCount);
+			for (uint32_t i = 0; i < entityCount; i++)
+				ids.push_back(scene.createEntity("Bench").getUUID());
+
+			Timer timer;
+			uint64_t found = 0;
+			for (uint32_t i = 0; i < lookups; i++) {
+				Entity entity = scene.getEntityById(ids[(i * 7919u) % entityCount]);
+				found += entity.isValid() ? 1 : 0;
+			}
+			float elapsed = timer.ElapsedMillis();
+			s_Sink = found;
+
+			std::cout << "  " << entityCount << " entities: " << lookups << " lookups in "
+				<< elapsed << " ms (" << elapsed * 1000000.0f / lookups << " ns/lookup)" << std::endl;
+		}
+	}
+
+	void InstancedQuads() {
+		std::cout << "[Renderer2D quads: vertex vs instanced]" << std::endl;
+
+		constexpr uint32_t spriteCount = 100000;
+		std::vector<glm::mat4> transforms;
+		transforms.reserve(spriteCount);
+		for (uint32_t i = 0; i < spriteCount; i++) {
+			glm::vec3 position = { (float)(i % 400) * 0.1f, (float)(i / 400) * 0.1f, 0.0f };
+			transforms.push_back(glm::translate(glm::mat4(1.0f), position) * glm::scale(glm::mat4(1.0f), { 0.08f, 0.08f, 1.0f }));
+		}
+
+		OrthoCamera camera(-1.0f, 1.0f, -1.0f, 1.0f);
+
+		for (bool instanced : { false, true }) {
+			Renderer2DSpecification specification;
+			specification.InstancedQuads = instanced;
+			Renderer2D::Init(specification);
+
+			constexpr uint32_t frames = 10;
+			float submitMillis = 0.0f;
+			float totalMillis = 0.0f;
+			Renderer2D::ResetStats();
+
+			for (uint32_t frame = 0; frame < frames; frame++) {
+				Timer total;
+				Renderer2D::BeginScene(camera);
+
+				Timer submit;
+				for (uint32_t i = 0; i < spriteCount; i++)
+					Renderer2D::DrawQuad(transforms[i], glm::vec4(1.0f, 0.5f, 0.2f, 1.0f), (int)i);
+				submitMillis += submit.ElapsedMillis();
+
+				Renderer2D::EndScene();
+				totalMillis += total.ElapsedMillis();
+			}
+
+			auto stats = Renderer2D::GetStats();
+			std::cout << "  " << (instanced ? "instanced" : "vertex   ") << ": "
+				<< stats.UploadedBytes / frames << " bytes uploaded, "
+				<< submitMillis / frames << " ms submission, "
+				<< totalMillis / frames << " ms submission + flush per " << spriteCount << " sprites" << std::endl;
+
+			Renderer2D::Shutdown();
+		}
+	}
+
+	void ParallelSpriteRecording() {
+		std::cout << "[Renderer2DRecorder: sprite vertex generation per worker count]" << std::endl;
+
+		constexpr uint32_t spriteCount = 200000;
+		std::vector<glm::mat4> transforms;
+		transforms.reserve(spriteCount);
+		for (uint32_t i = 0; i < spriteCount; i++) {
+			glm::vec3 position = { (float)(i % 500) * 0.1f, (float)(i / 500) * 0.1f, 0.0f };
+			transforms.push_back(glm::translate(glm::mat4(1.0f), position) * glm::scale(glm::mat4(1.0f), { 0.08f, 0.08f, 1.0f }));
+		}
+		SpriteRendererComponent sprite({ 1.0f, 0.5f, 0.2f, 1.0f });
+
+		Renderer2D::Init();
+		OrthoCamera camera(-1.0f, 1.0f, -1.0f, 1.0f);
+
+		const uint32_t maxWorkers = std::max(std::thread::hardware_concurrency(), 1u);
+		for (uint32_t workers = 1; workers <= maxWorkers; workers *= 2) {
+			// Same path as Scene::DrawSprites: the renderer's persistent workers, the main thread records chunk 0
+			const uint32_t chunk = (spriteCount + workers - 1) / workers;
+			auto record = [&](Renderer2DRecorder& recorder, uint32_t worker) {
+				recorder.reset();
+				for (uint32_t i = worker * chunk; i < std::min((worker + 1) * chunk, spriteCount); i++)
+					recorder.drawSprite(transforms[i], sprite, (int)i);
+			};
+
+			// Warm up, so starting the workers is not measured
+			Renderer2D::RecordParallel(workers, record);
+
+			constexpr uint32_t frames = 10;
+			float recordMillis = 0.0f;
+			float mergeMillis = 0.0f;
+			for (uint32_t frame = 0; frame < frames; frame++) {
+				Renderer2D::BeginScene(camera);
+
+				Timer recordTimer;
+				Renderer2D::RecordParallel(workers, record);
+				recordMillis += recordTimer.ElapsedMillis();
+
+				Timer mergeTimer;
+				for (uint32_t worker = 0; worker < workers; worker++)
+					Renderer2D::Submit(Renderer2D::GetRecorder(worker));
+				mergeMillis += mergeTimer.ElapsedMillis();
+				Renderer2D::EndScene();
+			}
+
+			std::cout << "  " << workers << " workers: " << recordMillis / frames << " ms recording, "
+				<< mergeMillis / frames << " ms merge per " << spriteCount << " sprites" << std::endl;
+		}
+
+		Renderer2D::Shutdown();
+	}
+
+	void TexturedQuads() {
+		std::cout << "[Renderer2D textured quads: texture slot resolution]" << std::endl;
+
+		constexpr uint32_t spriteCount = 100000;
+		constexpr uint32_t textureCount = 64;
+
+		Renderer2D::Init();
+
+		// Not asset backed, the sandbox has no project. Handle draws add one AssetHandle probe on top
+		std::vector<Ref<Texture2D>> textures;
+		for (uint32_t i = 0; i < textureCount; i++) {
+			Ref<Texture2D> texture = CreateRef<Texture2D>(1u, 1u);
+			uint32_t color = 0xff000000 | (i * 0x030507);
+			texture->setData(Buffer(&color, sizeof(uint32_t)));
+			textures.push_back(texture);
+		}
+
+		std::vector<glm::mat4> transforms;
+		transforms.reserve(spriteCount);
+		for (uint32_t i = 0; i < spriteCount; i++) {
+			glm::vec3 position = { (float)(i % 400) * 0.1f, (float)(i / 400) * 0.1f, 0.0f };
+			transforms.push_back(glm::translate(glm::mat4(1.0f), position) * glm::scale(glm::mat4(1.0f), { 0.08f, 0.08f, 1.0f }));
+		}
+
+		OrthoCamera camera(-1.0f, 1.0f, -1.0f, 1.0f);
+
+		constexpr uint32_t frames = 10;
+		float submitMillis = 0.0f;
+		float totalMillis = 0.0f;
+		Renderer2D::ResetStats();
+
+		for (uint32_t frame = 0; frame < frames; frame++) {
+			Timer total;
+			Renderer2D::BeginScene(camera);
+
+			Timer submit;
+			for (uint32_t i = 0; i < spriteCount; i++)
+				Renderer2D::DrawQuad(transforms[i], textures[(i * 7u) % textureCount], 1.0f, glm::vec4(1.0f), (int)i);
+			submitMillis += submit.ElapsedMillis();
+
+			Renderer2D::EndScene();
+			totalMillis += total.ElapsedMillis();
+		}
+
+		auto stats = Renderer2D::GetStats();
+		std::cout << "  " << spriteCount << " quads, " << textureCount << " textures: "
+			<< submitMillis * 1000000.0f / (frames * spriteCount) << " ns/quad submission, "
+			<< totalMillis / frames << " ms submission + flush, "
+			<< stats.DrawCalls / frames << " draw calls per frame" << std::endl;
+
+		textures.clear();
+		Renderer2D::Shutdown();
+	}
+}
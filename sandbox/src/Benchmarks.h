@@ -0,0 +1,16 @@
+#pragma once
+
+namespace Shado::Benchmarks {
+	/**
+	 * Runs the CPU-side engine benchmarks and prints the results to stdout.
+	 * Invoked by passing --bench to the sandbox executable
+	 */
+	void RunAll();
+
+	void SceneEntityLookup();
+
+	// Needs a GL context, Application::get() creates one
+	void InstancedQuads();
+	void ParallelSpriteRecording();
+	void TexturedQuads();
+}
@@ -1,5 +1,8 @@
 ﻿#include "Shado.h"
 #include <iostream>
+#include <cstring>
+
+#include "Benchmarks.h"
 
 using namespace Shado;
 
@@ -100,6 +103,13 @@ private:
 
 int main(int argc, const char** argv)
 {
+	for (int i = 1; i < argc; i++) {
+		if (std::strcmp(argv[i], "--bench") == 0) {
+			Benchmarks::RunAll();
+			return 0;
+		}
+	}
+
 	auto& application = Application::get();
 	application.getWindow().resize(1920, 1080);
 	application.submit(new TestLayer);
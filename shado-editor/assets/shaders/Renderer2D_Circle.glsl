@@ -11,10 +11,12 @@ layout(location = 1) in vec3 a_LocalPosition;
 layout(location = 2) in vec4 a_Color;
 layout(location = 3) in float a_Thickness;
 layout(location = 4) in float a_Fade;
-layout(location = 5) in int a_EntityID;
-layout(location = 6) in vec2 a_TexCoord;
-layout(location = 7) in float a_TexIndex;
-layout(location = 8) in float a_TilingFactor;
+layout(location = 5) in vec2 a_TexCoord;
+layout(location = 6) in float a_TexIndex;
+layout(location = 7) in float a_TilingFactor;
+#if SHADO_EDITOR_DATA
+layout(location = 8) in int a_EntityID;
+#endif
 
 layout(std140, binding = 0) uniform Camera
 {
@@ -30,7 +32,9 @@ struct VertexOutput
 };
 
 layout (location = 0) out VertexOutput Output;
+#if SHADO_EDITOR_DATA
 layout (location = 4) out flat int v_EntityID;
+#endif
 layout (location = 5) out vec2 v_TexCoord;
 layout (location = 6) out flat float v_TexIndex;
 layout (location = 7) out float v_TilingFactor;
@@ -42,7 +46,9 @@ void main()
 	Output.Thickness = a_Thickness;
 	Output.Fade = a_Fade;
 
+#if SHADO_EDITOR_DATA
 	v_EntityID = a_EntityID;
+#endif
 
 	v_TexCoord = a_TexCoord;
 	v_TexIndex = a_TexIndex;
@@ -55,7 +61,9 @@ void main()
 #version 450 core
 
 layout(location = 0) out vec4 o_Color;
+#if SHADO_EDITOR_DATA
 layout(location = 1) out int o_EntityID;
+#endif
 
 struct VertexOutput
 {
@@ -66,16 +74,21 @@ struct VertexOutput
 };
 
 layout (location = 0) in VertexOutput Input;
+#if SHADO_EDITOR_DATA
 layout (location = 4) in flat int v_EntityID;
+#endif
 layout (location = 5) in vec2 v_TexCoord;
 layout (location = 6) in flat float v_TexIndex;
 layout (location = 7) in float v_TilingFactor;
 
 layout (binding = 0) uniform sampler2D u_Textures[32];
 
-uniform float u_Time;
-uniform vec2 u_ScreenResolution;
-uniform vec2 u_MousePos;
+layout(std140, binding = 1) uniform Frame
+{
+	vec2 u_ScreenResolution;
+	vec2 u_MousePos;
+	float u_Time;
+};
 
 void main()
 {
@@ -97,5 +110,7 @@ void main()
 	// support indexing into arrays with constant indices. If you encounter a crash, try
 	// using a switch statement instead from 0 to 31 to sample the texture.
 	o_Color *= texture(u_Textures[int(v_TexIndex)], v_TexCoord * v_TilingFactor);
+#if SHADO_EDITOR_DATA
 	o_EntityID = v_EntityID;
+#endif
 }
\ No newline at end of file
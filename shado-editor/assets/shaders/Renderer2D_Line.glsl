@@ -8,7 +8,9 @@
 
 layout(location = 0) in vec3 a_Position;
 layout(location = 1) in vec4 a_Color;
+#if SHADO_EDITOR_DATA
 layout(location = 2) in int a_EntityID;
+#endif
 
 layout(std140, binding = 0) uniform Camera
 {
@@ -21,12 +23,16 @@ struct VertexOutput
 };
 
 layout (location = 0) out VertexOutput Output;
+#if SHADO_EDITOR_DATA
 layout (location = 1) out flat int v_EntityID;
+#endif
 
 void main()
 {
 	Output.Color = a_Color;
+#if SHADO_EDITOR_DATA
 	v_EntityID = a_EntityID;
+#endif
 
 	gl_Position = u_ViewProjection * vec4(a_Position, 1.0);
 }
@@ -35,7 +41,9 @@ void main()
 #version 450 core
 
 layout(location = 0) out vec4 o_Color;
+#if SHADO_EDITOR_DATA
 layout(location = 1) out int o_EntityID;
+#endif
 
 struct VertexOutput
 {
@@ -43,14 +51,21 @@ struct VertexOutput
 };
 
 layout (location = 0) in VertexOutput Input;
+#if SHADO_EDITOR_DATA
 layout (location = 1) in flat int v_EntityID;
+#endif
 
-uniform float u_Time;
-uniform vec2 u_ScreenResolution;
-uniform vec2 u_MousePos;
+layout(std140, binding = 1) uniform Frame
+{
+	vec2 u_ScreenResolution;
+	vec2 u_MousePos;
+	float u_Time;
+};
 
 void main()
 {
 	o_Color = Input.Color;
+#if SHADO_EDITOR_DATA
 	o_EntityID = v_EntityID;
+#endif
 }
\ No newline at end of file
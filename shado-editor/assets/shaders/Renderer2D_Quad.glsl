@@ -8,7 +8,9 @@ layout(location = 1) in vec4 a_Color;
 layout(location = 2) in vec2 a_TexCoord;
 layout(location = 3) in float a_TexIndex;
 layout(location = 4) in float a_TilingFactor;
+#if SHADO_EDITOR_DATA
 layout(location = 5) in int a_EntityID;
+#endif
 
 layout(std140, binding = 0) uniform Camera
 {
@@ -24,7 +26,9 @@ struct VertexOutput
 
 layout (location = 0) out VertexOutput Output;
 layout (location = 3) out flat float v_TexIndex;
+#if SHADO_EDITOR_DATA
 layout (location = 4) out flat int v_EntityID;
+#endif
 
 void main()
 {
@@ -32,7 +36,9 @@ void main()
 	Output.TexCoord = a_TexCoord;
 	Output.TilingFactor = a_TilingFactor;
 	v_TexIndex = a_TexIndex;
+#if SHADO_EDITOR_DATA
 	v_EntityID = a_EntityID;
+#endif
 
 	gl_Position = u_ViewProjection * vec4(a_Position, 1.0);
 }
@@ -41,7 +47,9 @@ void main()
 #version 450 core
 
 layout(location = 0) out vec4 o_Color;
+#if SHADO_EDITOR_DATA
 layout(location = 1) out int o_EntityID;
+#endif
 
 struct VertexOutput
 {
@@ -52,13 +60,18 @@ struct VertexOutput
 
 layout (location = 0) in VertexOutput Input;
 layout (location = 3) in flat float v_TexIndex;
+#if SHADO_EDITOR_DATA
 layout (location = 4) in flat int v_EntityID;
+#endif
 
 layout (binding = 0) uniform sampler2D u_Textures[32];
 
-uniform float u_Time;
-uniform vec2 u_ScreenResolution;
-uniform vec2 u_MousePos;
+layout(std140, binding = 1) uniform Frame
+{
+	vec2 u_ScreenResolution;
+	vec2 u_MousePos;
+	float u_Time;
+};
 
 void main()
 {
@@ -72,5 +85,7 @@ void main()
 
 	o_Color = texColor;
 	//o_Color.a = Input.Color.a;
+#if SHADO_EDITOR_DATA
 	o_EntityID = v_EntityID;
+#endif
 }
\ No newline at end of file
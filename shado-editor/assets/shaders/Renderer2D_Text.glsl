@@ -6,7 +6,9 @@
 layout(location = 0) in vec3 a_Position;
 layout(location = 1) in vec4 a_Color;
 layout(location = 2) in vec2 a_TexCoord;
+#if SHADO_EDITOR_DATA
 layout(location = 3) in int a_EntityID;
+#endif
 
 layout(std140, binding = 0) uniform Camera
 {
@@ -20,13 +22,17 @@ struct VertexOutput
 };
 
 layout (location = 0) out VertexOutput Output;
+#if SHADO_EDITOR_DATA
 layout (location = 2) out flat int v_EntityID;
+#endif
 
 void main()
 {
 	Output.Color = a_Color;
 	Output.TexCoord = a_TexCoord;
+#if SHADO_EDITOR_DATA
 	v_EntityID = a_EntityID;
+#endif
 
 	gl_Position = u_ViewProjection * vec4(a_Position, 1.0);
 }
@@ -35,7 +41,9 @@ void main()
 #version 450 core
 
 layout(location = 0) out vec4 o_Color;
+#if SHADO_EDITOR_DATA
 layout(location = 1) out int o_EntityID;
+#endif
 
 struct VertexOutput
 {
@@ -44,7 +52,9 @@ struct VertexOutput
 };
 
 layout (location = 0) in VertexOutput Input;
+#if SHADO_EDITOR_DATA
 layout (location = 2) in flat int v_EntityID;
+#endif
 
 layout (binding = 0) uniform sampler2D u_FontAtlas;
 
@@ -75,5 +85,7 @@ void main()
 	if (o_Color.a == 0.0)
 		discard;
 	
+#if SHADO_EDITOR_DATA
 	o_EntityID = v_EntityID;
+#endif
 }
\ No newline at end of file
@@ -67,6 +67,8 @@ namespace Shado {
         if (m_ViewportSize != *((glm::vec2*)&m_viewportPanelSize) && m_viewportPanelSize.x > 0 && m_viewportPanelSize.y
             > 0) {
             m_ViewportSize = {m_viewportPanelSize.x, m_viewportPanelSize.y};
+            // In flight picks were issued against the old size
+            buffer->discardPixelReadbacks();
             buffer->resize((uint32_t)m_ViewportSize.x, (uint32_t)m_ViewportSize.y);
 
             m_EditorCamera.SetViewportSize(m_ViewportSize.x, m_ViewportSize.y);
@@ -115,11 +117,18 @@ namespace Shado {
         int mouseX = (int)mx;
         int mouseY = (int)my;
 
-        if (mouseX >= 0 && mouseY >= 0 && mouseX < (int)viewportSize.x && mouseY < (int)viewportSize.y) {
-            int pixelData = buffer->readPixel(1, mouseX, mouseY);
-            m_HoveredEntity = pixelData == -1
-                                  ? Entity()
-                                  : Entity{(entt::entity)(uint32_t)pixelData, m_ActiveScene.Raw()};
+        // The read is queued behind this frame's draws and comes back a frame or two later, so the hovered
+        // entity lags the cursor slightly instead of draining the GPU pipeline every frame
+        bool mouseInViewport = mouseX >= 0 && mouseY >= 0 && mouseX < (int)viewportSize.x && mouseY < (int)viewportSize.y;
+        if (mouseInViewport)
+            buffer->readPixelAsync(1, mouseX, mouseY);
+
+        if (std::optional<int> pixelData = buffer->pollPixelReadback(); pixelData && mouseInViewport) {
+            // The entity may have been destroyed since the read was queued
+            Entity hovered = *pixelData == -1
+                                 ? Entity()
+                                 : Entity{(entt::entity)(uint32_t)*pixelData, m_ActiveScene.Raw()};
+            m_HoveredEntity = hovered.isValid() ? hovered : Entity();
         }
 
         buffer->unbind();
@@ -698,6 +707,9 @@ namespace Shado {
         ImGui::Text("Lines calls: %d", stats.LineCount);
         ImGui::Text("Total indices: %d", stats.GetTotalVertexCount());
         ImGui::Text("Total vertices: %d", stats.GetTotalVertexCount());
+        ImGui::Text("Uploaded: %.1f KB", stats.UploadedBytes / 1024.0f);
+        ImGui::Text("Visible entities: %d", stats.VisibleCount);
+        ImGui::Text("Culled entities: %d", stats.CulledCount);
         ImGui::NewLine();
         ImGui::Text("FPS: %d", (int)lastDt.toFPS());
         ImGui::End();
@@ -13,6 +13,7 @@
 #include "asset/Importer.h"
 #include "renderer/FrameBuffer.h"
 #include "renderer/Renderer2D.h"
+#include "renderer/RenderTargetPool.h"
 #include "scene/Components.h"
 #include "scene/Prefab.h"
 #include "util/FileSystem.h"
@@ -130,6 +131,10 @@ namespace Shado {
                         auto relativePath = std::filesystem::relative(path, Project::GetAssetDirectory());
                         Project::GetActive()->GetEditorAssetManager()->ImportAsset(relativePath);
                     }
+                    if (isImage(path) && path.extension() != ".ktx2" && ImGui::MenuItem("Import Compressed (KTX2)")) {
+                        auto relativePath = std::filesystem::relative(path, Project::GetAssetDirectory());
+                        Project::GetActive()->GetEditorAssetManager()->ImportCompressedTexture(relativePath);
+                    }
 
                     if (ImGui::MenuItem("Open..."))
                         Dialog::openPathInExplorer(path.string());
@@ -234,17 +239,17 @@ namespace Shado {
         }
         else if (path.extension() == ".shadoscene") {
             //icon = m_SceneIcon;
-            Ref<Framebuffer> fb;
+            Ref<Texture2D> thumbnail;
             if (!m_GeneratedThumbnails.contains(path.string())) {
-                fb = generateSceneThumbnail(path, m_ThumbnailSize);
+                thumbnail = generateSceneThumbnail(path, m_ThumbnailSize);
             }
             else {
-                fb = m_GeneratedThumbnails[path.string()];
+                thumbnail = m_GeneratedThumbnails[path.string()];
             }
 
             return {
-                fb->getColorAttachmentRendererID(),
-                (float)fb->getSpecification().Width / (float)fb->getSpecification().Height
+                thumbnail->getRendererID(),
+                (float)thumbnail->getWidth() / (float)thumbnail->getHeight()
             };
         }
         else if (path.extension() == ".prefab") {
@@ -261,11 +266,11 @@ namespace Shado {
             icon = m_FileIcon;
             // We do this every frame to keep the shader thumbnail animated
             // try {
-            //     Ref<Framebuffer> fb = generateShaderThumbnail(path, m_ThumbnailSize);
+            //     Ref<Texture2D> thumbnail = generateShaderThumbnail(path, m_ThumbnailSize);
             //
             //     return {
-            //         fb->getColorAttachmentRendererID(),
-            //         (float)fb->getSpecification().Width / (float)fb->getSpecification().Height
+            //         thumbnail->getRendererID(),
+            //         (float)thumbnail->getWidth() / (float)thumbnail->getHeight()
             //     };
             // }
             // catch (const std::runtime_error& e) {
@@ -276,7 +281,7 @@ namespace Shado {
         return {icon->getRendererID(), (float)icon->getWidth() / (float)icon->getHeight()};
     }
 
-    Ref<Framebuffer> ContentBrowserPanel::generateSceneThumbnail(const std::filesystem::path& path, uint32_t width) {
+    Ref<Texture2D> ContentBrowserPanel::generateSceneThumbnail(const std::filesystem::path& path, uint32_t width) {
         FramebufferSpecification specs;
         specs.Attachments = {
             FramebufferTextureFormat::RGBA8, FramebufferTextureFormat::RED_INTEGER,
@@ -285,7 +290,8 @@ namespace Shado {
         specs.Width = width;
         specs.Height = width / Application::get().getWindow().getAspectRatio();
 
-        auto fb = Framebuffer::create(specs);
+        // Every scene thumbnail has the same spec, so they all render through one pooled framebuffer
+        auto fb = RenderTargetPool::Acquire(specs);
 
         Ref<Scene> scene = CreateRef<Scene>();
         SceneSerializer serializer(scene);
@@ -301,38 +307,37 @@ namespace Shado {
         scene->onDrawEditor(camera);
         fb->unbind();
 
-        m_GeneratedThumbnails[path.string()] = fb;
+        Ref<Texture2D> thumbnail = fb->copyColorAttachment();
+        RenderTargetPool::Release(fb);
 
-        return fb;
+        m_GeneratedThumbnails[path.string()] = thumbnail;
+        return thumbnail;
     }
 
     // TODO: Fix this after AssetManager was implemented
-    Ref<Framebuffer> ContentBrowserPanel::generateShaderThumbnail(const std::filesystem::path& path, uint32_t width) {
+    Ref<Texture2D> ContentBrowserPanel::generateShaderThumbnail(const std::filesystem::path& path, uint32_t width) {
         // Cache shaders to animate them
         static std::unordered_map<std::string, Ref<Shader>> m_CachedShaders;
 
-        Ref<Framebuffer> fb;
         Ref<Shader> shader;
-        if (!m_GeneratedThumbnails.contains(path.string())) {
-            FramebufferSpecification specs;
-            specs.Attachments = {
-                FramebufferTextureFormat::RGBA8, FramebufferTextureFormat::RED_INTEGER,
-                FramebufferTextureFormat::DEPTH24STENCIL8
-            };
-            specs.Width = width;
-            specs.Height = width;
-
-            fb = Framebuffer::create(specs);
+        if (!m_CachedShaders.contains(path.string())) {
             shader = ShaderImporter::LoadShader(path);
             m_CachedShaders[path.string()] = shader;
-
-            m_GeneratedThumbnails[path.string()] = fb;
         }
         else {
-            fb = m_GeneratedThumbnails[path.string()];
             shader = m_CachedShaders[path.string()];
         }
 
+        FramebufferSpecification specs;
+        specs.Attachments = {
+            FramebufferTextureFormat::RGBA8, FramebufferTextureFormat::RED_INTEGER,
+            FramebufferTextureFormat::DEPTH24STENCIL8
+        };
+        specs.Width = width;
+        specs.Height = width;
+
+        // Redrawn every frame, the pooled target is shared by all shader thumbnails of this size
+        auto fb = RenderTargetPool::Acquire(specs);
         fb->bind();
         Renderer2D::Clear();
 
@@ -350,10 +355,14 @@ namespace Shado {
         Renderer2D::EndScene();
         fb->unbind();
 
-        return fb;
+        Ref<Texture2D> thumbnail = fb->copyColorAttachment(0, m_GeneratedThumbnails[path.string()]);
+        RenderTargetPool::Release(fb);
+
+        m_GeneratedThumbnails[path.string()] = thumbnail;
+        return thumbnail;
     }
 
     static bool isImage(const std::filesystem::path& path) {
-        return path.extension() == ".jpg" || path.extension() == ".png";
+        return path.extension() == ".jpg" || path.extension() == ".png" || path.extension() == ".ktx2";
     }
 }
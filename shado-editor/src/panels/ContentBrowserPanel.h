@@ -25,8 +25,8 @@ namespace Shado {
 
         void setDirectory(const std::filesystem::path& path);
         ThumbnailMetadata getThumbnail(const std::filesystem::directory_entry&);
-        Ref<Framebuffer> generateSceneThumbnail(const std::filesystem::path& path, uint32_t width);
-        Ref<Framebuffer> generateShaderThumbnail(const std::filesystem::path& path, uint32_t width);
+        Ref<Texture2D> generateSceneThumbnail(const std::filesystem::path& path, uint32_t width);
+        Ref<Texture2D> generateShaderThumbnail(const std::filesystem::path& path, uint32_t width);
 
     private:
         float m_ThumbnailSize = 100.0f;
@@ -38,7 +38,8 @@ namespace Shado {
         Ref<Texture2D> m_PrefabIcon;
         Ref<Texture2D> m_CSIcon;
         Ref<Texture2D> m_SlnIcon;
-        std::unordered_map<std::string, Ref<Framebuffer>> m_GeneratedThumbnails;
+        // Thumbnails are rendered in pooled framebuffers and copied out, only the color texture is kept
+        std::unordered_map<std::string, Ref<Texture2D>> m_GeneratedThumbnails;
 
         std::vector<std::filesystem::directory_entry> directories;
         uint32_t tick = 1;
@@ -129,6 +129,7 @@ namespace Shado {
 
         drawComponent<SpriteRendererComponent>("Sprite", entity, [](SpriteRendererComponent& sprite) {
             ImGui::ColorEdit4("Colour", glm::value_ptr(sprite.color));
+            ImGui::Checkbox("Static", &sprite.isStatic);
             drawTextureControl(&sprite);
         });
 
@@ -140,6 +141,30 @@ namespace Shado {
             drawTextureControl(&circle, "Circle");
         });
 
+        drawComponent<TilemapComponent>("Tilemap", entity, [](TilemapComponent& tilemap) {
+            std::string atlasPath = tilemap.atlas
+                                        ? AssetManager::GetPathFromHandle(tilemap.atlas).string()
+                                        : "No Atlas";
+            UI::InputTextWithChooseFile("Atlas", atlasPath, {".jpg", ".png", ".ktx2"},
+                                        typeid(tilemap.atlas).hash_code(), [&](std::string path) {
+                                            tilemap.atlas = Project::GetActive()->GetEditorAssetManager()->
+                                                ImportAsset(path);
+                                        }
+            );
+
+            int atlasGrid[2] = {(int)tilemap.atlasGrid.x, (int)tilemap.atlasGrid.y};
+            if (ImGui::DragInt2("Atlas columns / rows", atlasGrid, 0.1f, 1, 4096))
+                tilemap.atlasGrid = {(uint32_t)std::max(atlasGrid[0], 1), (uint32_t)std::max(atlasGrid[1], 1)};
+
+            ImGui::DragFloat2("Tile size", glm::value_ptr(tilemap.tileSize), 0.01f);
+            ImGui::ColorEdit4("Colour", glm::value_ptr(tilemap.color));
+
+            // Resizing reallocates every chunk, so it is only applied on enter
+            int size[2] = {(int)tilemap.getWidth(), (int)tilemap.getHeight()};
+            if (ImGui::InputInt2("Size", size, ImGuiInputTextFlags_EnterReturnsTrue))
+                tilemap.resize((uint32_t)std::max(size[0], 0), (uint32_t)std::max(size[1], 0));
+        });
+
         drawComponent<LineRendererComponent>("Line Renderer", entity, [](LineRendererComponent& line) {
             drawVec3Control("Target", line.target);
             ImGui::ColorEdit4("Colour", glm::value_ptr(line.color));
@@ -658,6 +683,11 @@ namespace Shado {
                 ImGui::CloseCurrentPopup();
             }
 
+            if (!m_Selected.hasComponent<TilemapComponent>() && ImGui::MenuItem("Tilemap")) {
+                m_Selected.addComponent<TilemapComponent>();
+                ImGui::CloseCurrentPopup();
+            }
+
             ImGui::EndPopup();
         }
         ImGui::PopItemWidth();
@@ -671,7 +701,7 @@ namespace Shado {
         std::string texturePath = sprite.texture
                                       ? AssetManager::GetPathFromHandle(sprite.texture).string()
                                       : "No Texture";
-        UI::InputTextWithChooseFile("Texture", texturePath, {".jpg", ".png"}, typeid(sprite.texture).hash_code(),
+        UI::InputTextWithChooseFile("Texture", texturePath, {".jpg", ".png", ".ktx2"}, typeid(sprite.texture).hash_code(),
                                     [&](std::string path) {
                                         AssetHandle textureHandle = Project::GetActive()->GetEditorAssetManager()->
                                             ImportAsset(path);
@@ -693,6 +723,10 @@ namespace Shado {
         // =========== Tilling factor
         ImGui::DragFloat("Tilling factor", &sprite.tilingFactor, 0.01);
 
+        // =========== Texture region, circles do not share this part of the sprite layout
+        if (type == "Quad")
+            ImGui::DragFloat4("UV rect", &sprite.uvRect.x, 0.001f, 0.0f, 1.0f);
+
         ImGui::Separator();
 
         // =========== Shader
@@ -748,6 +782,19 @@ namespace Shado {
         // Draw shader uniforms
         if (sprite.shader) {
             auto shader = AssetManager::GetAsset<Shader>(sprite.shader);
+            if (shader->hasFailed()) {
+                UI::NewLine();
+                ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.9f, 0.3f, 0.3f, 1.0f));
+                UI::Text("Shader failed to compile");
+                ImGui::TextWrapped("%s", shader->getCompileError().c_str());
+                ImGui::PopStyleColor();
+                return;
+            }
+            if (!shader->isReady()) {
+                UI::NewLine();
+                UI::Text("Shader is compiling...");
+                return;
+            }
             auto uniforms = shader->getActiveUniforms();
 
             UI::NewLine();
@@ -84,13 +84,13 @@ namespace Shado {
         m_PropertiesPanel.resetSelection();
     }
 
-    static bool isChildSelectedRecursively(Entity entity, Entity selected) {
-        if (entity == selected)
-            return true;
-
-        for (Entity child : entity.getChildren()) {
-            if (isChildSelectedRecursively(child, selected))
+    static bool isChildSelectedRecursively(Entity entity, Entity selected, Scene& scene) {
+        // Walk up from the selection instead of down the whole subtree, O(depth)
+        for (uint32_t depth = 0; selected && depth < 1024; depth++) {
+            if (entity == selected)
                 return true;
+
+            selected = selected.getComponent<TransformComponent>().getParent(scene);
         }
 
         return false;
@@ -110,7 +110,7 @@ namespace Shado {
                                        entity.hasComponent<PrefabInstanceComponent>());
 
             // if a child is selected then expand the parent
-            flags |= isChildSelectedRecursively(entity, m_Selected) ? ImGuiTreeNodeFlags_DefaultOpen : 0;
+            flags |= isChildSelectedRecursively(entity, m_Selected, *m_Context.Raw()) ? ImGuiTreeNodeFlags_DefaultOpen : 0;
             opened = ImGui::TreeNodeEx((void*)(uint64_t)(uint32_t)entity, flags, tc.tag.c_str());
             if (ImGui::IsItemClicked()) {
                 setSelected(entity);
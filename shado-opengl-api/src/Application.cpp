@@ -6,6 +6,8 @@
 #include "GL/glew.h"
 #include "project/Project.h"
 #include "renderer/Renderer2D.h"
+#include "renderer/RenderTargetPool.h"
+#include "renderer/TextureStreamer.h"
 #include "scene/Scene.h"
 #include "script/ScriptEngine.h"
 #include "util/Random.h"
@@ -72,6 +74,10 @@ namespace Shado {
                 m_MainThreadQueue.clear();
             }
 
+            Shader::PollPendingCompilations();
+            TextureStreamer::Update();
+            RenderTargetPool::NextFrame();
+
             if (!m_minimized) {
                 /* Render here */
                 // Draw scenes here
@@ -200,6 +206,8 @@ namespace Shado {
 
         get().m_Running = false;
 
+        TextureStreamer::Shutdown();
+        RenderTargetPool::Clear();
         Renderer2D::Shutdown();
         for (const auto& cb : get().m_TeardownCallbacks)
             cb();
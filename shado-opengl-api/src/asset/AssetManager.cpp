@@ -11,7 +11,7 @@ namespace Shado {
         auto extension = filepath.extension();
         if (extension == ".scene")
             return AssetType::Scene;
-        if (extension == ".png" || extension == ".jpg")
+        if (extension == ".png" || extension == ".jpg" || extension == ".ktx2")
             return AssetType::Texture2D;
         if (extension == ".shader" || extension == ".glsl")
             return AssetType::Shader;
@@ -40,6 +40,14 @@ namespace Shado {
         return out;
     }
 
+    const SpriteAtlas* AssetManager::GetSpriteAtlas() {
+        Ref<Project> project = Project::GetActive();
+        if (!project || !project->GetAssetManager())
+            return nullptr;
+
+        return project->GetAssetManager()->GetSpriteAtlas();
+    }
+
     bool EditorAssetManager::IsAssetHandleValid(AssetHandle handle) const {
         return handle != 0 && m_AssetRegistry.find(handle) != m_AssetRegistry.end();
     }
@@ -68,6 +76,16 @@ namespace Shado {
         return handle;
     }
 
+    AssetHandle EditorAssetManager::ImportCompressedTexture(const std::filesystem::path& filepath, bool serializeToRegistry) {
+        std::filesystem::path compressedPath = filepath;
+        compressedPath.replace_extension(".ktx2");
+
+        if (!TextureImporter::ConvertToKTX2(Project::GetProjectDirectory() / filepath,
+                                            Project::GetProjectDirectory() / compressedPath))
+            return 0;
+        return ImportAsset(compressedPath, serializeToRegistry);
+    }
+
     AssetHandle EditorAssetManager::GetHandleFromPath(const std::filesystem::path& filepath) {
         return std::ranges::find_if(m_AssetRegistry,
                                     [&filepath](const auto& pair) { return pair.second.FilePath == filepath; })->first;
@@ -209,6 +227,21 @@ namespace Shado {
                 metadata.DateModified = node["DateModified"].as<uint64_t>();
             }
         }
+
+        BuildSpriteAtlas();
         return true;
     }
+
+    void EditorAssetManager::BuildSpriteAtlas() {
+        SHADO_PROFILE_FUNCTION();
+
+        std::vector<std::pair<AssetHandle, std::filesystem::path>> textures;
+        for (const auto& [handle, metadata] : m_AssetRegistry) {
+            if (metadata.Type == AssetType::Texture2D)
+                textures.emplace_back(handle, Project::GetProjectDirectory() / metadata.FilePath);
+        }
+
+        m_SpriteAtlas = CreateRef<SpriteAtlas>();
+        m_SpriteAtlas->build(textures);
+    }
 }
@@ -3,6 +3,7 @@
 
 #include "Asset.h"
 #include "project/Project.h"
+#include "renderer/SpriteAtlas.h"
 #include "util/Memory.h"
 
 #define SHADO_ASSET_MANAGER_VERSION "0.0.1"
@@ -20,6 +21,9 @@ namespace Shado {
         virtual bool IsAssetHandleValid(AssetHandle handle) const = 0;
         virtual bool IsAssetLoaded(AssetHandle handle) const = 0;
         virtual bool IsPathInRegistry(const std::filesystem::path& path) const = 0;
+
+        /** Atlas of the small texture assets, null if the manager did not build one */
+        virtual const SpriteAtlas* GetSpriteAtlas() const { return nullptr; }
     };
 
     /**
@@ -42,6 +46,9 @@ namespace Shado {
         static std::filesystem::path GetPathFromHandle(AssetHandle handle) {
             return Project::GetActive()->GetAssetManager()->GetPathFromHandle(handle);
         }
+
+        /** @return The sprite atlas of the active project, or nullptr if there is none */
+        static const SpriteAtlas* GetSpriteAtlas();
     };
 
 
@@ -68,6 +75,11 @@ namespace Shado {
         virtual bool IsPathInRegistry(const std::filesystem::path& path) const override;
 
         AssetHandle ImportAsset(const std::filesystem::path& filepath, bool serializeToRegistry = true);
+        /**
+         * Converts an image to a block compressed .ktx2 next to it and imports that instead
+         * @return 0 if the conversion failed
+         */
+        AssetHandle ImportCompressedTexture(const std::filesystem::path& filepath, bool serializeToRegistry = true);
 
 
         void SerializeAssetRegistry();
@@ -76,9 +88,17 @@ namespace Shado {
         const AssetRegistry& GetAssetRegistry() const { return m_AssetRegistry; }
         const AssetMetadata& GetMetadata(AssetHandle handle) const;
 
+        /**
+         * Packs the small textures of the registry into atlas pages in the background, see SpriteAtlas::build.
+         * Textures imported afterwards keep their own texture until the next build
+         */
+        void BuildSpriteAtlas();
+        const SpriteAtlas* GetSpriteAtlas() const override { return m_SpriteAtlas.Raw(); }
+
     private:
         AssetRegistry m_AssetRegistry;
         AssetMap m_LoadedAssets;
+        Ref<SpriteAtlas> m_SpriteAtlas;
         // TODO: memory-only assets
     };
 
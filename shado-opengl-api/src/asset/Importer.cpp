@@ -3,13 +3,18 @@
 #include <functional>
 #include <map>
 
+#include "KTX2.h"
 #include "stb_image.h"
 #include "debug/Debug.h"
 #include "debug/Profile.h"
 #include "project/Project.h"
 #include "renderer/Texture2D.h"
+#include "renderer/TextureCache.h"
+#include "renderer/TextureCompressor.h"
+#include "renderer/TextureStreamer.h"
 #include "renderer/Shader.h"
 #include "util/Buffer.h"
+#include "util/FileSystem.h"
 
 namespace Shado {
     using AssetImportFunction = std::function<Ref<Asset>(AssetHandle, const AssetMetadata&)>;
@@ -30,12 +35,18 @@ namespace Shado {
 
     Ref<Texture2D> TextureImporter::ImportTexture2D(AssetHandle handle, const AssetMetadata& metadata) {
         SHADO_PROFILE_FUNCTION();
-        return LoadTexture2D(Project::GetProjectDirectory() / metadata.FilePath);
+        if (metadata.FilePath.extension() == ".ktx2")
+            return LoadKTX2(Project::GetProjectDirectory() / metadata.FilePath);
+
+        // Project textures are requested lazily while rendering, so they are decoded and uploaded in the background
+        return TextureStreamer::Load(Project::GetProjectDirectory() / metadata.FilePath);
     }
 
     Ref<Texture2D> TextureImporter::LoadTexture2D(const std::filesystem::path& path) {
         SHADO_PROFILE_FUNCTION();
         SHADO_CORE_TRACE("Importing Texture2D {0}", path.string());
+        if (path.extension() == ".ktx2")
+            return LoadKTX2(path);
 
         int width, height, channels;
         stbi_set_flip_vertically_on_load(1);
@@ -77,25 +88,97 @@ namespace Shado {
         return texture;
     }
 
+    bool TextureImporter::ConvertToKTX2(const std::filesystem::path& source, const std::filesystem::path& destination,
+                                        std::optional<Texture2DChannelFormat> format) {
+        SHADO_PROFILE_FUNCTION();
+
+        int width, height, channels;
+        std::string sourceStr = source.string();
+        stbi_set_flip_vertically_on_load(1);
+        stbi_uc* pixels = stbi_load(sourceStr.c_str(), &width, &height, &channels, 4);
+        if (!pixels) {
+            SHADO_CORE_ERROR("TextureImporter::ConvertToKTX2 - could not decode {}", sourceStr);
+            return false;
+        }
+
+        KTX2Image image;
+        image.Format = format.value_or(TextureCompressor::ChooseFormat(pixels, width, height));
+        image.Width = width;
+        image.Height = height;
+        image.YUp = true;
+        SHADO_CORE_ASSERT(TextureCompressor::CanEncode(image.Format), "Format {} cannot be encoded",
+                          (uint32_t)image.Format);
+
+        // Each level is downsampled from the previous uncompressed one, then compressed
+        std::vector<uint8_t> level(pixels, pixels + (size_t)width * height * 4);
+        stbi_image_free(pixels);
+
+        const uint32_t mipCount = TextureCache::GetMipCount(width, height);
+        std::vector<std::vector<uint8_t>> compressed(mipCount);
+        uint32_t levelWidth = width, levelHeight = height;
+        for (uint32_t mip = 0; mip < mipCount; mip++) {
+            compressed[mip] = TextureCompressor::Compress(level.data(), levelWidth, levelHeight, image.Format);
+            image.Levels.emplace_back(compressed[mip].data(), compressed[mip].size());
+
+            if (mip + 1 < mipCount) {
+                std::vector<uint8_t> next((size_t)std::max(levelWidth / 2, 1u) * std::max(levelHeight / 2, 1u) * 4);
+                TextureCache::Downsample(level.data(), levelWidth, levelHeight, next.data());
+                level.swap(next);
+                levelWidth = std::max(levelWidth / 2, 1u);
+                levelHeight = std::max(levelHeight / 2, 1u);
+            }
+        }
+
+        return KTX2::Write(destination, image);
+    }
+
+    Ref<Texture2D> TextureImporter::LoadKTX2(const std::filesystem::path& path) {
+        SHADO_PROFILE_FUNCTION();
+
+        // Blocks go to the driver straight from the mapping, nothing is decoded on the CPU
+        MappedFile file(path);
+        KTX2Image image;
+        if (!file.isValid() || !KTX2::Read(file.getData(), file.getSize(), image)) {
+            SHADO_CORE_ERROR("TextureImporter::LoadKTX2 - could not read {}", path.string());
+            return nullptr;
+        }
+        if (!image.YUp)
+            SHADO_CORE_WARN("{} is stored top row first and will render upside down, re-export it with KTXorientation \"ru\"",
+                            path.string());
+
+        Texture2DSpecification spec;
+        spec.width = image.Width;
+        spec.height = image.Height;
+        spec.format = image.Format;
+        spec.mipLevels = (uint32_t)image.Levels.size();
+        spec.path = path;
+
+        Ref<Texture2D> texture = CreateRef<Texture2D>(spec);
+        for (uint32_t level = 0; level < (uint32_t)image.Levels.size(); level++)
+            texture->setCompressedData(level, image.Levels[level]);
+
+        SHADO_CORE_TRACE("Created compressed texture {}x{} with {} mips (RendererId: {})", image.Width, image.Height,
+                         spec.mipLevels, texture->getRendererID());
+        return texture;
+    }
+
     Ref<Shader> ShaderImporter::ImportShader(AssetHandle handle, const AssetMetadata& metadata) {
         SHADO_PROFILE_FUNCTION();
-        return LoadShader(Project::GetProjectDirectory() / metadata.FilePath);
+        return LoadShader(Project::GetProjectDirectory() / metadata.FilePath, true);
     }
 
-    Ref<Shader> ShaderImporter::LoadShader(const std::filesystem::path& path) {
-        // Read file from filesystem
-        std::string source;
-        {
-            std::ifstream file(path);
-            if (!file.is_open()) {
-                SHADO_CORE_ERROR("Could not open shader file: {}", path.string());
-                return nullptr;
-            }
+    Ref<Shader> ShaderImporter::LoadShader(const std::filesystem::path& path, bool async) {
+        SHADO_PROFILE_FUNCTION();
 
-            std::stringstream ss;
-            ss << file.rdbuf();
-            source = ss.str();
+        // Read file from filesystem in one go, the source is only hashed when the program binary is cached
+        Buffer file = FileSystem::ReadFileBinary(path);
+        if (!file) {
+            SHADO_CORE_ERROR("Could not open shader file: {}", path.string());
+            return nullptr;
         }
-        return CreateRef<Shader>(source);
+
+        std::string source(file.As<char>(), file.Size);
+        file.Release();
+        return CreateRef<Shader>(source, async);
     }
 }
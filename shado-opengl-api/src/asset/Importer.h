@@ -1,10 +1,12 @@
 #pragma once
+#include <optional>
+
 #include "Asset.h"
+#include "renderer/Texture2D.h"
 #include "util/Memory.h"
 
 namespace Shado {
     class Shader;
-    class Texture2D;
 
     class AssetImporter {
     public:
@@ -18,11 +20,22 @@ namespace Shado {
         // Reads file directly from filesystem
         // (i.e. path has to be relative / absolute to working directory)
         static Ref<Texture2D> LoadTexture2D(const std::filesystem::path& path);
+
+        /**
+         * Decodes an image, builds its mips and writes them block compressed to a KTX2 file.
+         * When no format is given BC1 or BC3 is picked from the alpha channel
+         */
+        static bool ConvertToKTX2(const std::filesystem::path& source, const std::filesystem::path& destination,
+                                  std::optional<Texture2DChannelFormat> format = {});
+
+    private:
+        static Ref<Texture2D> LoadKTX2(const std::filesystem::path& path);
     };
 
     class ShaderImporter {
     public:
         static Ref<Shader> ImportShader(AssetHandle handle, const AssetMetadata& metadata);
-        static Ref<Shader> LoadShader(const std::filesystem::path& path);
+        // Project shaders are imported with async set, engine shaders are needed right away
+        static Ref<Shader> LoadShader(const std::filesystem::path& path, bool async = false);
     };
 }
@@ -0,0 +1,220 @@
+#include "KTX2.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <string_view>
+
+#include "debug/Debug.h"
+
+namespace Shado {
+    static constexpr uint8_t Identifier[12] = {0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+
+    struct KTX2Header {
+        uint8_t Identifier[12];
+        uint32_t VkFormat;
+        uint32_t TypeSize;
+        uint32_t PixelWidth, PixelHeight, PixelDepth;
+        uint32_t LayerCount, FaceCount, LevelCount;
+        uint32_t SupercompressionScheme;
+
+        uint32_t DfdByteOffset, DfdByteLength;
+        uint32_t KvdByteOffset, KvdByteLength;
+        uint64_t SgdByteOffset, SgdByteLength;
+    };
+    static_assert(sizeof(KTX2Header) == 80);
+
+    struct KTX2LevelIndex {
+        uint64_t ByteOffset;
+        uint64_t ByteLength;
+        uint64_t UncompressedByteLength;
+    };
+
+    struct KTX2FormatInfo {
+        Texture2DChannelFormat Format;
+        uint32_t VkFormat;
+        uint8_t ColorModel; // Khronos data format descriptor model
+    };
+
+    // sRGB variants are read as linear, the renderer treats every other texture as linear too
+    static constexpr KTX2FormatInfo s_Formats[] = {
+        {Texture2DChannelFormat::BC1, 133, 128}, // VK_FORMAT_BC1_RGBA_UNORM_BLOCK
+        {Texture2DChannelFormat::BC1, 131, 128}, // VK_FORMAT_BC1_RGB_UNORM_BLOCK
+        {Texture2DChannelFormat::BC1, 132, 128}, // VK_FORMAT_BC1_RGB_SRGB_BLOCK
+        {Texture2DChannelFormat::BC1, 134, 128}, // VK_FORMAT_BC1_RGBA_SRGB_BLOCK
+        {Texture2DChannelFormat::BC3, 137, 130}, // VK_FORMAT_BC3_UNORM_BLOCK
+        {Texture2DChannelFormat::BC3, 138, 130}, // VK_FORMAT_BC3_SRGB_BLOCK
+        {Texture2DChannelFormat::BC4, 139, 131}, // VK_FORMAT_BC4_UNORM_BLOCK
+        {Texture2DChannelFormat::BC5, 141, 132}, // VK_FORMAT_BC5_UNORM_BLOCK
+        {Texture2DChannelFormat::BC7, 145, 134}, // VK_FORMAT_BC7_UNORM_BLOCK
+        {Texture2DChannelFormat::BC7, 146, 134}, // VK_FORMAT_BC7_SRGB_BLOCK
+    };
+
+    static const KTX2FormatInfo* FindFormat(uint32_t vkFormat) {
+        for (const KTX2FormatInfo& info : s_Formats)
+            if (info.VkFormat == vkFormat)
+                return &info;
+        return nullptr;
+    }
+
+    static const KTX2FormatInfo* FindFormat(Texture2DChannelFormat format) {
+        for (const KTX2FormatInfo& info : s_Formats)
+            if (info.Format == format)
+                return &info;
+        return nullptr;
+    }
+
+    static bool ReadOrientation(const uint8_t* kvd, uint32_t length) {
+        uint32_t offset = 0;
+        while (offset + 4 <= length) {
+            uint32_t entryLength;
+            std::memcpy(&entryLength, kvd + offset, 4);
+            if (entryLength > length - offset - 4)
+                break;
+
+            const char* entry = (const char*)kvd + offset + 4;
+            const size_t keyLength = strnlen(entry, entryLength);
+            if (std::string_view(entry, keyLength) == "KTXorientation" && keyLength + 2 < entryLength)
+                return entry[keyLength + 2] == 'u';
+
+            offset += 4 + ((entryLength + 3) & ~3u);
+        }
+        return false; // Default orientation is "rd"
+    }
+
+    bool KTX2::Read(const uint8_t* data, uint64_t size, KTX2Image& image) {
+        KTX2Header header;
+        if (size < sizeof(header))
+            return false;
+
+        std::memcpy(&header, data, sizeof(header));
+        if (std::memcmp(header.Identifier, Identifier, sizeof(Identifier)) != 0)
+            return false;
+
+        const KTX2FormatInfo* format = FindFormat(header.VkFormat);
+        if (!format) {
+            SHADO_CORE_ERROR("KTX2 - unsupported vkFormat {}", header.VkFormat);
+            return false;
+        }
+        if (header.PixelDepth > 1 || header.LayerCount > 1 || header.FaceCount != 1 || header.SupercompressionScheme != 0) {
+            SHADO_CORE_ERROR("KTX2 - only uncompressed single layer 2D textures are supported");
+            return false;
+        }
+
+        const uint32_t levelCount = std::max(header.LevelCount, 1u);
+        if (sizeof(header) + (uint64_t)levelCount * sizeof(KTX2LevelIndex) > size)
+            return false;
+
+        image.Format = format->Format;
+        image.Width = header.PixelWidth;
+        image.Height = header.PixelHeight;
+        image.Levels.clear();
+
+        for (uint32_t level = 0; level < levelCount; level++) {
+            KTX2LevelIndex index;
+            std::memcpy(&index, data + sizeof(header) + level * sizeof(KTX2LevelIndex), sizeof(index));
+
+            const uint32_t expected = GetCompressedImageSize(image.Format, std::max(image.Width >> level, 1u),
+                                                             std::max(image.Height >> level, 1u));
+            if (index.ByteLength != expected || index.ByteOffset + index.ByteLength > size) {
+                SHADO_CORE_ERROR("KTX2 - level {} is truncated or has an unexpected size", level);
+                return false;
+            }
+            image.Levels.emplace_back(data + index.ByteOffset, index.ByteLength);
+        }
+
+        image.YUp = header.KvdByteLength > 0 && (uint64_t)header.KvdByteOffset + header.KvdByteLength <= size &&
+            ReadOrientation(data + header.KvdByteOffset, header.KvdByteLength);
+        return true;
+    }
+
+    static void AppendKeyValue(std::vector<uint8_t>& kvd, std::string_view key, std::string_view value) {
+        const uint32_t length = (uint32_t)(key.size() + value.size() + 2);
+        const size_t start = kvd.size();
+        kvd.resize(start + 4 + ((length + 3) & ~3u), 0);
+        std::memcpy(kvd.data() + start, &length, 4);
+        std::memcpy(kvd.data() + start + 4, key.data(), key.size());
+        std::memcpy(kvd.data() + start + 4 + key.size() + 1, value.data(), value.size());
+    }
+
+    bool KTX2::Write(const std::filesystem::path& path, const KTX2Image& image) {
+        const KTX2FormatInfo* format = FindFormat(image.Format);
+        SHADO_CORE_ASSERT(format && !image.Levels.empty(), "KTX2 - nothing to write");
+
+        // Basic data format descriptor, one or two 64 bit samples per block
+        const bool twoSamples = image.Format == Texture2DChannelFormat::BC3 || image.Format == Texture2DChannelFormat::BC5;
+        const uint8_t blockBytes = image.Format == Texture2DChannelFormat::BC1 || image.Format == Texture2DChannelFormat::BC4 ? 8 : 16;
+        const uint16_t blockSize = 24 + (twoSamples ? 32 : 16);
+
+        std::vector<uint8_t> dfd(4 + blockSize, 0);
+        const uint32_t dfdSize = (uint32_t)dfd.size();
+        std::memcpy(dfd.data(), &dfdSize, 4);
+        uint8_t* block = dfd.data() + 4;
+        const uint16_t version = 2;
+        std::memcpy(block + 4, &version, 2);
+        std::memcpy(block + 6, &blockSize, 2);
+        block[8] = format->ColorModel;
+        block[9] = 1;  // BT.709 primaries
+        block[10] = 1; // Linear transfer
+        block[12] = 3; // 4x4 texel blocks
+        block[13] = 3;
+        block[16] = blockBytes;
+
+        // BC3 stores alpha then color, BC5 red then green
+        const uint8_t channels[2] = {uint8_t(image.Format == Texture2DChannelFormat::BC3 ? 15 : 0),
+                                     uint8_t(image.Format == Texture2DChannelFormat::BC3 ? 0 : 1)};
+        for (uint32_t i = 0; i < (twoSamples ? 2u : 1u); i++) {
+            uint8_t* sample = block + 24 + i * 16;
+            const uint16_t bitOffset = (uint16_t)(i * 64);
+            std::memcpy(sample, &bitOffset, 2);
+            sample[2] = (twoSamples ? 64 : blockBytes * 8) - 1;
+            sample[3] = channels[i];
+            const uint32_t upper = UINT32_MAX;
+            std::memcpy(sample + 12, &upper, 4);
+        }
+
+        std::vector<uint8_t> kvd;
+        AppendKeyValue(kvd, "KTXorientation", "ru");
+        AppendKeyValue(kvd, "KTXwriter", "Shado Engine");
+
+        KTX2Header header = {};
+        std::memcpy(header.Identifier, Identifier, sizeof(Identifier));
+        header.VkFormat = format->VkFormat;
+        header.TypeSize = 1;
+        header.PixelWidth = image.Width;
+        header.PixelHeight = image.Height;
+        header.FaceCount = 1;
+        header.LevelCount = (uint32_t)image.Levels.size();
+        header.DfdByteOffset = (uint32_t)(sizeof(header) + image.Levels.size() * sizeof(KTX2LevelIndex));
+        header.DfdByteLength = (uint32_t)dfd.size();
+        header.KvdByteOffset = header.DfdByteOffset + header.DfdByteLength;
+        header.KvdByteLength = (uint32_t)kvd.size();
+
+        // Level data goes smallest mip first, each aligned to the block size
+        auto align = [](uint64_t offset) { return (offset + 15) & ~15ull; };
+        std::vector<KTX2LevelIndex> levels(image.Levels.size());
+        uint64_t offset = align(header.KvdByteOffset + header.KvdByteLength);
+        for (size_t i = image.Levels.size(); i-- > 0;) {
+            levels[i] = {offset, image.Levels[i].Size, image.Levels[i].Size};
+            offset = align(offset + image.Levels[i].Size);
+        }
+
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            SHADO_CORE_ERROR("KTX2 - could not write {}", path.string());
+            return false;
+        }
+
+        out.write((const char*)&header, sizeof(header));
+        out.write((const char*)levels.data(), levels.size() * sizeof(KTX2LevelIndex));
+        out.write((const char*)dfd.data(), dfd.size());
+        out.write((const char*)kvd.data(), kvd.size());
+        for (size_t i = image.Levels.size(); i-- > 0;) {
+            const uint64_t padding = levels[i].ByteOffset - (uint64_t)out.tellp();
+            static constexpr char zeros[16] = {};
+            out.write(zeros, padding);
+            out.write((const char*)image.Levels[i].Data, image.Levels[i].Size);
+        }
+        return (bool)out;
+    }
+}
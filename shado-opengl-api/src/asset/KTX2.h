@@ -0,0 +1,32 @@
+#pragma once
+#include <filesystem>
+#include <vector>
+
+#include "renderer/Texture2D.h"
+#include "util/Buffer.h"
+
+namespace Shado {
+    /**
+     * Block compressed 2D texture stored in a KTX2 container. Levels point into the data the image was read
+     * from and are ordered from the base level down
+     */
+    struct KTX2Image {
+        Texture2DChannelFormat Format = Texture2DChannelFormat::BC7;
+        uint32_t Width = 0, Height = 0;
+        std::vector<Buffer> Levels;
+        bool YUp = false; // KTXorientation "ru", rows start at the bottom like GL expects
+    };
+
+    /**
+     * Minimal KTX2 reader and writer. Only 2D, single layer, uncompressed containers holding one of the
+     * Texture2DChannelFormat block formats are supported
+     */
+    class KTX2 {
+    public:
+        /** @return false if data is not a KTX2 file this engine can upload */
+        static bool Read(const uint8_t* data, uint64_t size, KTX2Image& image);
+
+        /** Levels are written bottom row first and tagged "ru" */
+        static bool Write(const std::filesystem::path& path, const KTX2Image& image);
+    };
+}
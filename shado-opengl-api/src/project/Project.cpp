@@ -5,6 +5,8 @@
 #include "Application.h"
 #include "ProjectSerializer.h"
 #include "asset/AssetManager.h"
+#include "renderer/ShaderCache.h"
+#include "renderer/TextureCache.h"
 #include "script/ScriptEngine.h"
 #include "util/FileSystem.h"
 #include "scene/Scene.h"
@@ -40,6 +42,16 @@ namespace Shado {
         s_ActiveProject = project;
         if (s_ActiveProject)
             ScriptEngine::GetMutable().Initialize(s_ActiveProject);
+
+        // Project shaders and textures are cached with the project, engine ones stay in the working directory cache
+        if (s_ActiveProject && !s_ActiveProject->m_ProjectDirectory.empty()) {
+            ShaderCache::SetDirectory(GetCacheDirectory() / "Shaders");
+            TextureCache::SetDirectory(GetCacheDirectory() / "Textures");
+        }
+        else {
+            ShaderCache::SetDirectory("Cache/Shaders");
+            TextureCache::SetDirectory("Cache/Textures");
+        }
     }
 
     Ref<Project> Project::New() {
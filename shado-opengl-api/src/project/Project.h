@@ -40,6 +40,11 @@ namespace Shado {
             return GetAssetDirectory() / path;
         }
 
+        static std::filesystem::path GetCacheDirectory() {
+            SHADO_CORE_ASSERT(s_ActiveProject, "");
+            return GetProjectDirectory() / "Cache";
+        }
+
         static std::filesystem::path GetAssetRegistryPath() {
             SHADO_CORE_ASSERT(s_ActiveProject, "Cannot get asset registry path without an active project");
             return GetProjectDirectory() / s_ActiveProject->m_Config.AssetRegistryPath;
@@ -1,6 +1,8 @@
 #include "Buffer.h"
 
 #include "GL/glew.h"
+#include "debug/Profile.h"
+#include <cstring>
 
 namespace Shado {
     ShaderDataType ShaderDataTypeFromGLType(uint32_t openGLType) {
@@ -35,8 +37,15 @@ namespace Shado {
         glBufferData(GL_ARRAY_BUFFER, size, vertices, GL_STATIC_DRAW);
     }
 
+    VertexBuffer::VertexBuffer(uint32_t size, uint32_t sectionCount)
+        : m_Stream(CreateScoped<StreamingBuffer>(size, sectionCount)) {
+        m_RendererID = m_Stream->getRendererID();
+    }
+
     VertexBuffer::~VertexBuffer() {
-        glDeleteBuffers(1, &m_RendererID);
+        // The stream owns its buffer
+        if (!m_Stream)
+            glDeleteBuffers(1, &m_RendererID);
     }
 
     void VertexBuffer::bind() const {
@@ -51,15 +60,118 @@ namespace Shado {
         return CreateRef<VertexBuffer>(vertices, size);
     }
 
-    void VertexBuffer::setData(const void* data, size_t size) {
+    uint32_t VertexBuffer::setData(const void* data, size_t size) {
+        if (m_Stream) {
+            std::memcpy(map((uint32_t)size), data, size);
+            return commit((uint32_t)size);
+        }
+
         glBindBuffer(GL_ARRAY_BUFFER, m_RendererID);
         glBufferSubData(GL_ARRAY_BUFFER, 0, size, data);
+        return 0;
+    }
+
+    void* VertexBuffer::map(uint32_t size) {
+        SHADO_CORE_ASSERT(m_Stream, "Only streaming vertex buffers can be mapped");
+        return m_Stream->map(size);
+    }
+
+    uint32_t VertexBuffer::commit(uint32_t size) {
+        SHADO_CORE_ASSERT(m_Stream, "Only streaming vertex buffers can be mapped");
+        return m_Stream->commit(size);
     }
 
     Ref<VertexBuffer> VertexBuffer::create(uint32_t size) {
         return CreateRef<VertexBuffer>(size);
     }
 
+    Ref<VertexBuffer> VertexBuffer::createStreaming(uint32_t size, uint32_t sectionCount) {
+        return CreateRef<VertexBuffer>(size, sectionCount);
+    }
+
+    // ========================================
+    StreamingBuffer::StreamingBuffer(uint32_t sectionSize, uint32_t sectionCount, uint32_t alignment)
+        : m_SectionSize((sectionSize + alignment - 1) / alignment * alignment), m_SectionCount(sectionCount),
+          m_Alignment(alignment), m_Fences(sectionCount, nullptr) {
+        SHADO_CORE_ASSERT(sectionCount > 0, "A streaming buffer needs at least one section");
+
+        const GLsizeiptr totalSize = (GLsizeiptr)m_SectionSize * m_SectionCount;
+        glCreateBuffers(1, &m_RendererID);
+
+        m_Persistent = GLEW_ARB_buffer_storage;
+        if (m_Persistent) {
+            constexpr GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            glNamedBufferStorage(m_RendererID, totalSize, nullptr, flags);
+            m_Mapped = (uint8_t*)glMapNamedBufferRange(m_RendererID, 0, totalSize, flags);
+        }
+        else {
+            SHADO_CORE_WARN("GL_ARB_buffer_storage is not supported, streaming buffers fall back to glBufferSubData");
+            glNamedBufferData(m_RendererID, totalSize, nullptr, GL_STREAM_DRAW);
+            m_Mapped = Memory::Heap<uint8_t>(m_SectionSize, "Renderer");
+        }
+    }
+
+    StreamingBuffer::~StreamingBuffer() {
+        for (void* fence : m_Fences) {
+            if (fence)
+                glDeleteSync((GLsync)fence);
+        }
+
+        if (m_Persistent)
+            glUnmapNamedBuffer(m_RendererID);
+        else
+            Memory::FreeRaw(m_Mapped, "Renderer");
+
+        glDeleteBuffers(1, &m_RendererID);
+    }
+
+    void* StreamingBuffer::map(uint32_t size) {
+        SHADO_CORE_ASSERT(size <= m_SectionSize, "Streaming buffer section is too small");
+
+        m_Cursor = (m_Cursor + m_Alignment - 1) / m_Alignment * m_Alignment;
+        if (m_Cursor + size > m_SectionSize) {
+            // The GPU has been sent every command reading this section, fence them before moving on
+            m_Fences[m_Section] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            enterSection((m_Section + 1) % m_SectionCount);
+        }
+
+        if (!m_Persistent)
+            return m_Mapped;
+        return m_Mapped + m_Section * m_SectionSize + m_Cursor;
+    }
+
+    uint32_t StreamingBuffer::commit(uint32_t size) {
+        const uint32_t offset = m_Section * m_SectionSize + m_Cursor;
+        if (!m_Persistent && size)
+            glNamedBufferSubData(m_RendererID, offset, size, m_Mapped);
+
+        m_Cursor += size;
+        return offset;
+    }
+
+    void StreamingBuffer::enterSection(uint32_t section) {
+        SHADO_PROFILE_FUNCTION();
+
+        m_Section = section;
+        m_Cursor = 0;
+
+        GLsync fence = (GLsync)m_Fences[section];
+        if (!fence)
+            return;
+
+        // Only blocks when the CPU is a full ring ahead of the GPU
+        constexpr GLuint64 timeout = 1000000; // 1ms
+        GLenum result = glClientWaitSync(fence, 0, 0);
+        while (result == GL_TIMEOUT_EXPIRED)
+            result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeout);
+
+        if (result == GL_WAIT_FAILED)
+            SHADO_CORE_ERROR("glClientWaitSync failed on a streaming buffer section");
+
+        glDeleteSync(fence);
+        m_Fences[section] = nullptr;
+    }
+
     // ========================================
     Ref<IndexBuffer> IndexBuffer::create(uint32_t* indices, uint32_t count) {
         return CreateRef<IndexBuffer>(indices, count);
@@ -7,7 +7,12 @@
 
 namespace Shado {
     enum class ShaderDataType {
-        None = 0, Float, Float2, Float3, Float4, Mat3, Mat4, Int, Int2, Int3, Int4, Bool, Sampler2D
+        None = 0, Float, Float2, Float3, Float4, Mat3, Mat4, Int, Int2, Int3, Int4, Bool, Sampler2D,
+
+        // Compact vertex attributes, read as floats by the shader. Set Normalized on the element to map
+        // the integer types to [0, 1]
+        UByte4, UShort2, Half, Half2, Half4,
+        UInt1010102 // x, y, z in 10 bits and w in 2, lowest bits first
     };
 
     static uint32_t ShaderDataTypeSize(ShaderDataType type) {
@@ -23,6 +28,12 @@ namespace Shado {
         case ShaderDataType::Int3: return 4 * 3;
         case ShaderDataType::Int4: return 4 * 4;
         case ShaderDataType::Bool: return 1;
+        case ShaderDataType::UByte4: return 4;
+        case ShaderDataType::UShort2: return 2 * 2;
+        case ShaderDataType::Half: return 2;
+        case ShaderDataType::Half2: return 2 * 2;
+        case ShaderDataType::Half4: return 2 * 4;
+        case ShaderDataType::UInt1010102: return 4;
         }
 
         SHADO_CORE_ASSERT(false, "Unknown ShaderDataType!");
@@ -57,6 +68,12 @@ namespace Shado {
             case ShaderDataType::Int3: return 3;
             case ShaderDataType::Int4: return 4;
             case ShaderDataType::Bool: return 1;
+            case ShaderDataType::UByte4: return 4;
+            case ShaderDataType::UShort2: return 2;
+            case ShaderDataType::Half: return 1;
+            case ShaderDataType::Half2: return 2;
+            case ShaderDataType::Half4: return 4;
+            case ShaderDataType::UInt1010102: return 4;
             }
 
             SHADO_CORE_ASSERT(false, "Unknown ShaderDataType!");
@@ -69,12 +86,22 @@ namespace Shado {
         BufferLayout() {
         }
 
-        BufferLayout(const std::initializer_list<BufferElement>& elements)
-            : m_Elements(elements) {
+        /**
+         * @param elements The attributes, in the order they are laid out in memory
+         * @param instanceDivisor 0 for per-vertex data, N to advance the attributes once every N instances
+         */
+        BufferLayout(const std::initializer_list<BufferElement>& elements, uint32_t instanceDivisor = 0)
+            : m_Elements(elements), m_InstanceDivisor(instanceDivisor) {
+            CalculateOffsetsAndStride();
+        }
+
+        BufferLayout(std::vector<BufferElement> elements, uint32_t instanceDivisor = 0)
+            : m_Elements(std::move(elements)), m_InstanceDivisor(instanceDivisor) {
             CalculateOffsetsAndStride();
         }
 
         uint32_t getStride() const { return m_Stride; }
+        uint32_t getInstanceDivisor() const { return m_InstanceDivisor; }
         const std::vector<BufferElement>& getElements() const { return m_Elements; }
 
         std::vector<BufferElement>::iterator begin() { return m_Elements.begin(); }
@@ -95,12 +122,61 @@ namespace Shado {
 
         std::vector<BufferElement> m_Elements;
         uint32_t m_Stride = 0;
+        uint32_t m_InstanceDivisor = 0;
+    };
+
+    /**
+     * GPU buffer used as a ring of equally sized sections. The buffer is persistently mapped when
+     * glBufferStorage is available, otherwise writes are staged on the CPU and uploaded on commit.
+     * A fence is placed on each section when the ring moves past it and waited on before the section
+     * is written again, so the CPU never overwrites data the GPU may still be reading
+     */
+    class StreamingBuffer {
+    public:
+        /**
+         * @param sectionSize The largest block that can be written at once
+         * @param sectionCount Number of sections, i.e. how many frames the CPU can run ahead of the GPU
+         * @param alignment Offsets returned by commit are a multiple of this
+         */
+        StreamingBuffer(uint32_t sectionSize, uint32_t sectionCount = 3, uint32_t alignment = 1);
+        ~StreamingBuffer();
+
+        StreamingBuffer(const StreamingBuffer&) = delete;
+        StreamingBuffer& operator=(const StreamingBuffer&) = delete;
+
+        /**
+         * Reserves size bytes and returns where to write them. Only valid until the next commit
+         */
+        void* map(uint32_t size);
+
+        /**
+         * Publishes the first size bytes of the last reservation
+         * @return The offset of the data in the buffer
+         */
+        uint32_t commit(uint32_t size);
+
+        uint32_t getRendererID() const { return m_RendererID; }
+        bool isPersistent() const { return m_Persistent; }
+
+    private:
+        void enterSection(uint32_t section);
+
+        uint32_t m_RendererID = 0;
+        uint32_t m_SectionSize;
+        uint32_t m_SectionCount;
+        uint32_t m_Alignment;
+        uint32_t m_Section = 0;
+        uint32_t m_Cursor = 0; // Within the current section
+        bool m_Persistent = false;
+        uint8_t* m_Mapped = nullptr; // Whole buffer when persistent, one section of staging otherwise
+        std::vector<void*> m_Fences; // GLsync per section, null when the section is free
     };
 
     class VertexBuffer : public RefCounted {
     public:
         VertexBuffer(uint32_t size);
         VertexBuffer(float* vertices, uint32_t size);
+        VertexBuffer(uint32_t size, uint32_t sectionCount);
         virtual ~VertexBuffer();
 
         virtual void bind() const;
@@ -109,14 +185,39 @@ namespace Shado {
         virtual void setLayout(const BufferLayout& layout) { m_Layout = layout; };
         virtual const BufferLayout& getLayout() const { return m_Layout; };
 
-        virtual void setData(const void* data, size_t size);
+        /**
+         * @return The offset the data was written at. Always 0 unless the buffer is streaming
+         */
+        virtual uint32_t setData(const void* data, size_t size);
+
+        /**
+         * Streaming buffers only. Reserves size bytes of mapped memory to write vertices into directly.
+         * Every write must be a whole number of vertices so the offsets stay a multiple of the stride
+         */
+        void* map(uint32_t size);
+
+        /**
+         * Streaming buffers only. Publishes the first size bytes written since map
+         * @return The offset of the vertices, in bytes. Divide by the stride to get the base vertex
+         */
+        uint32_t commit(uint32_t size);
+
+        bool isStreaming() const { return (bool)m_Stream; }
 
         static Ref<VertexBuffer> create(uint32_t size);
         static Ref<VertexBuffer> create(float* vertices, uint32_t size);
 
+        /**
+         * Creates a dynamic buffer that is rewritten every frame
+         * @param size The most data that is written between two commits
+         * @param sectionCount How many blocks of size bytes are in flight before the CPU waits for the GPU
+         */
+        static Ref<VertexBuffer> createStreaming(uint32_t size, uint32_t sectionCount = 3);
+
     private:
         uint32_t m_RendererID;
         BufferLayout m_Layout;
+        ScopedRef<StreamingBuffer> m_Stream;
     };
 
     class IndexBuffer : public RefCounted {
@@ -1,6 +1,7 @@
 ﻿#include "Framebuffer.h"
 
 #include "debug/Debug.h"
+#include "Texture2D.h"
 #include "GL/glew.h"
 #include "GLFW/glfw3.h"
 #define STB_IMAGE_IMPLEMENTATION
@@ -110,6 +111,12 @@ namespace Shado {
 		glDeleteFramebuffers(1, &m_RendererID);
 		glDeleteTextures(m_ColorAttachments.size(), m_ColorAttachments.data());
 		glDeleteTextures(1, &m_DepthAttachment);
+
+		for (void* fence : m_ReadbackFences)
+			if (fence)
+				glDeleteSync((GLsync)fence);
+		if (m_ReadbackBuffer)
+			glDeleteBuffers(1, &m_ReadbackBuffer);
 	}
 
 	void Framebuffer::invalidate()
@@ -213,6 +220,84 @@ namespace Shado {
 
 	}
 
+	void Framebuffer::readPixelAsync(uint32_t attachmentIndex, int x, int y)
+	{
+		SHADO_CORE_ASSERT(attachmentIndex < m_ColorAttachments.size(), "");
+
+		// Every slot still in flight, the GPU is more than a few frames behind so skip this read
+		if (m_ReadbackCount == ReadbackSlots)
+			return;
+
+		if (!m_ReadbackBuffer)
+		{
+			constexpr GLbitfield flags = GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+			glCreateBuffers(1, &m_ReadbackBuffer);
+			glNamedBufferStorage(m_ReadbackBuffer, ReadbackSlots * sizeof(int), nullptr, flags);
+			m_ReadbackData = (const int*)glMapNamedBufferRange(m_ReadbackBuffer, 0, ReadbackSlots * sizeof(int), flags);
+		}
+
+		const uint32_t slot = (m_ReadbackHead + m_ReadbackCount) % ReadbackSlots;
+
+		glReadBuffer(GL_COLOR_ATTACHMENT0 + attachmentIndex);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, m_ReadbackBuffer);
+		glReadPixels(x, y, 1, 1, GL_RED_INTEGER, GL_INT, (void*)(uintptr_t)(slot * sizeof(int)));
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+		m_ReadbackFences[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		m_ReadbackCount++;
+	}
+
+	std::optional<int> Framebuffer::pollPixelReadback()
+	{
+		std::optional<int> result;
+
+		// Slots complete in order, stop at the first one the GPU has not reached
+		while (m_ReadbackCount > 0)
+		{
+			GLsync fence = (GLsync)m_ReadbackFences[m_ReadbackHead];
+			GLint status = GL_UNSIGNALED;
+			glGetSynciv(fence, GL_SYNC_STATUS, 1, nullptr, &status);
+			if (status != GL_SIGNALED)
+				break;
+
+			glDeleteSync(fence);
+			m_ReadbackFences[m_ReadbackHead] = nullptr;
+			result = m_ReadbackData[m_ReadbackHead];
+
+			m_ReadbackHead = (m_ReadbackHead + 1) % ReadbackSlots;
+			m_ReadbackCount--;
+		}
+
+		return result;
+	}
+
+	void Framebuffer::discardPixelReadbacks()
+	{
+		for (void*& fence : m_ReadbackFences)
+		{
+			if (fence)
+				glDeleteSync((GLsync)fence);
+			fence = nullptr;
+		}
+		m_ReadbackHead = 0;
+		m_ReadbackCount = 0;
+	}
+
+	Ref<Texture2D> Framebuffer::copyColorAttachment(uint32_t index, Ref<Texture2D> destination) const
+	{
+		SHADO_CORE_ASSERT(index < m_ColorAttachments.size(), "");
+		SHADO_CORE_ASSERT(m_ColorAttachmentSpecifications[index].TextureFormat == FramebufferTextureFormat::RGBA8 &&
+			m_Specification.Samples == 1, "Only single sampled RGBA8 attachments can be copied");
+
+		if (!destination || destination->getWidth() != (int)m_Specification.Width ||
+			destination->getHeight() != (int)m_Specification.Height)
+			destination = CreateRef<Texture2D>(m_Specification.Width, m_Specification.Height);
+
+		glCopyImageSubData(m_ColorAttachments[index], GL_TEXTURE_2D, 0, 0, 0, 0,
+			destination->getRendererID(), GL_TEXTURE_2D, 0, 0, 0, 0, m_Specification.Width, m_Specification.Height, 1);
+		return destination;
+	}
+
 	void Framebuffer::clearAttachment(uint32_t attachmentIndex, int value)
 	{
 		SHADO_CORE_ASSERT(attachmentIndex < m_ColorAttachments.size(), "");
@@ -1,4 +1,6 @@
 ﻿#pragma once
+#include <array>
+#include <optional>
 #include <glm/vec2.hpp>
 
 #include "debug/Debug.h"
@@ -6,6 +8,8 @@
 #include "util/TimeStep.h"
 
 namespace Shado {
+    class Texture2D;
+
     enum class FramebufferTextureFormat : int {
         None = 0,
 
@@ -62,6 +66,23 @@ namespace Shado {
         void resize(uint32_t width, uint32_t height);
         int readPixel(uint32_t attachmentIndex, int x, int y);
 
+        /**
+         * Queues a read of one RED_INTEGER texel into a pixel pack buffer without waiting for the GPU.
+         * The value is returned by pollPixelReadback() once its fence signals, usually 1-2 frames later.
+         * The framebuffer must be bound
+         */
+        void readPixelAsync(uint32_t attachmentIndex, int x, int y);
+        /** Newest async read that completed since the last call, if any */
+        std::optional<int> pollPixelReadback();
+        /** Drops the async reads still in flight */
+        void discardPixelReadbacks();
+
+        /**
+         * Copies a color attachment into a texture so the framebuffer can be reused.
+         * destination is reused when it has the same size, otherwise a new texture is created
+         */
+        Ref<Texture2D> copyColorAttachment(uint32_t index = 0, Ref<Texture2D> destination = nullptr) const;
+
         void clearAttachment(uint32_t attachmentIndex, int value);
 
         const FramebufferSpecification& getSpecification() const { return m_Specification; }
@@ -83,5 +104,13 @@ namespace Shado {
 
         std::vector<uint32_t> m_ColorAttachments;
         uint32_t m_DepthAttachment = 0;
+
+        // Async readback ring, one int per slot in a persistently mapped pack buffer
+        static constexpr uint32_t ReadbackSlots = 3;
+        uint32_t m_ReadbackBuffer = 0;
+        const int* m_ReadbackData = nullptr;
+        std::array<void*, ReadbackSlots> m_ReadbackFences = {}; // GLsync, null when the slot is free
+        uint32_t m_ReadbackHead = 0; // Oldest pending slot
+        uint32_t m_ReadbackCount = 0;
     };
 }
@@ -0,0 +1,73 @@
+#include "RenderTargetPool.h"
+
+#include <algorithm>
+
+#include "debug/Profile.h"
+
+namespace Shado {
+    struct PooledTarget {
+        Ref<Framebuffer> Target;
+        uint64_t ReleaseFrame = 0;
+    };
+
+    struct RenderTargetPoolData {
+        std::vector<PooledTarget> Free;
+        uint64_t Frame = 0;
+    };
+
+    static RenderTargetPoolData s_Pool;
+
+    static bool IsCompatible(const FramebufferSpecification& a, const FramebufferSpecification& b) {
+        if (a.Width != b.Width || a.Height != b.Height || a.Samples != b.Samples || a.SwapChainTarget != b.SwapChainTarget)
+            return false;
+
+        const auto& attachmentsA = a.Attachments.Attachments;
+        const auto& attachmentsB = b.Attachments.Attachments;
+        return std::ranges::equal(attachmentsA, attachmentsB, [](const auto& x, const auto& y) {
+            return x.TextureFormat == y.TextureFormat;
+        });
+    }
+
+    Ref<Framebuffer> RenderTargetPool::Acquire(const FramebufferSpecification& spec) {
+        SHADO_PROFILE_FUNCTION();
+
+        // Most recently released first, its attachments are the most likely to still be resident
+        for (auto it = s_Pool.Free.rbegin(); it != s_Pool.Free.rend(); ++it) {
+            if (IsCompatible(it->Target->getSpecification(), spec)) {
+                Ref<Framebuffer> target = it->Target;
+                s_Pool.Free.erase(std::next(it).base());
+                return target;
+            }
+        }
+
+        return Framebuffer::create(spec);
+    }
+
+    void RenderTargetPool::Release(const Ref<Framebuffer>& target) {
+        if (!target)
+            return;
+
+        // A pending pick from the previous user would otherwise show up in the next one
+        target->discardPixelReadbacks();
+        s_Pool.Free.push_back({target, s_Pool.Frame});
+
+        // Sizes that keep changing never hit the pool, bound what they can hold on to
+        if (s_Pool.Free.size() > MaxFreeTargets)
+            s_Pool.Free.erase(s_Pool.Free.begin());
+    }
+
+    void RenderTargetPool::NextFrame() {
+        s_Pool.Frame++;
+        std::erase_if(s_Pool.Free, [](const PooledTarget& pooled) {
+            return s_Pool.Frame - pooled.ReleaseFrame > MaxIdleFrames;
+        });
+    }
+
+    void RenderTargetPool::Clear() {
+        s_Pool.Free.clear();
+    }
+
+    uint32_t RenderTargetPool::GetFreeCount() {
+        return (uint32_t)s_Pool.Free.size();
+    }
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include <vector>
+
+#include "FrameBuffer.h"
+
+namespace Shado {
+    /**
+     * Pool of framebuffers keyed by size, attachment formats and sample count. Passes that only need a target
+     * for a moment acquire one, render, and release it. Released targets are reused by the next matching
+     * acquire and destroyed once they sat unused for MaxIdleFrames frames, or as soon as more than
+     * MaxFreeTargets of them are waiting, oldest first
+     */
+    class RenderTargetPool {
+    public:
+        static constexpr uint32_t MaxIdleFrames = 120;
+        static constexpr uint32_t MaxFreeTargets = 8;
+
+        static Ref<Framebuffer> Acquire(const FramebufferSpecification& spec);
+        /** The caller must not use the target after releasing it */
+        static void Release(const Ref<Framebuffer>& target);
+
+        /** Ages the released targets, called once per frame by the Application */
+        static void NextFrame();
+        static void Clear();
+
+        static uint32_t GetFreeCount();
+    };
+}
@@ -4,9 +4,17 @@
 #include "debug/Profile.h"
 #include <glm/glm.hpp>
 #include <glm/gtx/transform.hpp>
+#include <glm/gtc/packing.hpp>
+#include <glm/gtc/type_precision.hpp>
 #include "cameras/OrbitCamera.h"
 #include "VertexArray.h"
+#include <algorithm>
 #include <array>
+#include <cfloat>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
 
 #include "UniformBuffer.h"
 #include "scene/Components.h"
@@ -17,61 +25,155 @@
 #include <FontGeometry.h>
 #include "Events/input.h"
 #include "asset/AssetManager.h"
+#include "SpriteAtlas.h"
+#include "VertexPolicy.h"
+#include "ViewCulling.h"
 #include "asset/Importer.h"
 
-namespace Shado {
-    struct QuadVertex {
-        glm::vec3 Position;
-        glm::vec4 Color;
-        glm::vec2 TexCoord;
-        float TexIndex;
-        float TilingFactor;
+#if defined(_M_X64) || defined(__SSE2__)
+    #include <emmintrin.h>
+    #define SHADO_RENDERER2D_SSE2 1
+#endif
 
-        // Editor-only
-        int EntityID;
+namespace Shado {
+    // Packed vertex attributes. They are assigned the float values the draw calls compute and the shaders
+    // still read floats, the conversion happens in the vertex fetch
+    struct PackedColor { // UByte4, normalized
+        uint32_t Value;
+        PackedColor& operator=(const glm::vec4& color) { Value = glm::packUnorm4x8(color); return *this; }
     };
 
-    struct CircleVertex {
-        glm::vec3 WorldPosition;
-        glm::vec3 LocalPosition;
-        glm::vec4 Color;
-        float Thickness;
-        float Fade;
+    struct PackedUV { // UShort2, normalized. UVs are clamped to [0, 1], repetition goes through TilingFactor
+        glm::u16vec2 Value;
+        PackedUV& operator=(const glm::vec2& uv) { Value = glm::packUnorm<uint16_t>(uv); return *this; }
+        operator glm::vec2() const { return glm::unpackUnorm<float>(Value); }
+    };
 
-        // Editor-only
-        int EntityID;
+    struct PackedHalf {
+        uint16_t Value;
+        PackedHalf& operator=(float value) { Value = glm::packHalf1x16(value); return *this; }
+    };
 
-        glm::vec2 TexCoord;
-        float TexIndex;
-        float TilingFactor;
+    struct PackedHalf2 {
+        uint32_t Value;
+        PackedHalf2& operator=(const glm::vec2& value) { Value = glm::packHalf2x16(value); return *this; }
     };
 
-    struct LineVertex {
+    // Vertex records without the editor-only entity ID, which WithEntityID appends according to VertexPolicy
+    struct QuadVertexData {
         glm::vec3 Position;
-        glm::vec4 Color;
+        PackedColor Color;
+        PackedUV TexCoord;
+        PackedHalf TexIndex;
+        PackedHalf TilingFactor;
+    };
 
-        // Editor-only
-        int EntityID;
+    struct CircleVertexData {
+        glm::vec3 WorldPosition;
+        PackedHalf2 LocalPosition; // z is always 0, the shader gets it from the attribute default
+        PackedColor Color;
+        PackedHalf Thickness;
+        PackedHalf Fade;
+        PackedUV TexCoord;
+        PackedHalf TexIndex;
+        PackedHalf TilingFactor;
+    };
+
+    struct LineVertexData {
+        glm::vec3 Position;
+        PackedColor Color;
     };
 
-    struct TextVertex {
+    struct TextVertexData {
         glm::vec3 Position;
-        glm::vec4 Color;
-        glm::vec2 TexCoord;
+        PackedColor Color;
+        PackedUV TexCoord;
 
         // TODO: bg color for outline/bg
+    };
+
+    /**
+     * Per-instance record of the instanced quad pipeline. The corners are expanded in the vertex shader
+     */
+    struct QuadInstanceData {
+        glm::vec4 Transform; // 2D linear part, column 0 (xy) then column 1 (xy)
+        glm::vec3 Translation;
+        uint32_t Color; // RGBA8
+        glm::vec4 TexRect; // Min UV, max UV. The tiling factor is folded in
+        int TexIndex;
+    };
+
+    using QuadVertex = WithEntityID<QuadVertexData>;
+    using CircleVertex = WithEntityID<CircleVertexData>;
+    using LineVertex = WithEntityID<LineVertexData>;
+    using TextVertex = WithEntityID<TextVertexData>;
+    using QuadInstance = WithEntityID<QuadInstanceData>;
+
+    static constexpr uint32_t EntityIDSize = VertexPolicy::HasEntityID ? sizeof(int) : 0;
+    static_assert(sizeof(QuadVertex) == 24 + EntityIDSize);
+    static_assert(sizeof(CircleVertex) == 32 + EntityIDSize);
+    static_assert(sizeof(LineVertex) == 16 + EntityIDSize);
+    static_assert(sizeof(TextVertex) == 20 + EntityIDSize);
+    static_assert(sizeof(QuadInstance) == 52 + EntityIDSize);
+
+    /** Vertex layout of a record, followed by the entity ID attribute when the policy keeps it */
+    static BufferLayout MakeVertexLayout(std::vector<BufferElement> layout, uint32_t instanceDivisor = 0) {
+        if constexpr (VertexPolicy::HasEntityID)
+            layout.emplace_back(ShaderDataType::Int, "a_EntityID");
+        return BufferLayout(layout, instanceDivisor);
+    }
+
+    enum class DrawPacketType : uint8_t {
+        Quad = 0, Circle, Text, QuadInstance, ShaderQuad, Mesh
+    };
+
+    static std::vector<BufferElement> QuadVertexElements() {
+        return {
+            {ShaderDataType::Float3, "a_Position"},
+            {ShaderDataType::UByte4, "a_Color", true},
+            {ShaderDataType::UShort2, "a_TexCoord", true},
+            {ShaderDataType::Half, "a_TexIndex"},
+            {ShaderDataType::Half, "a_TilingFactor"}
+        };
+    }
+
+    static BufferLayout QuadVertexLayout() {
+        return MakeVertexLayout(QuadVertexElements());
+    }
 
-        // Editor-only
-        int EntityID;
+    // Location of a_EntityID in the quad shaders, right after the quad vertex elements
+    static constexpr uint32_t QuadEntityIDLocation = 5;
+
+    /**
+     * One queued primitive. The vertices are staged at submission, the packet only says where they are
+     * and how to order them. Sort key layout, most significant bits first:
+     *   opaque      [layer:4][blend:1][shader:12][texture:12][depth:32] (front to back)
+     *   translucent [layer:4][blend:1][depth:32][shader:12][texture:12] (back to front)
+     */
+    struct DrawPacket {
+        uint64_t Key;
+        uint32_t FirstVertex; // Into the staging array of Type. Instance index for QuadInstance, FrameMeshes for Mesh
+        uint16_t Texture; // Into Renderer2DData::FrameTextures
+        DrawPacketType Type;
+        uint8_t Shader; // Into Renderer2DData::FrameShaders, ShaderQuad only
     };
 
-    struct QuadFace {
-        uint32_t vertexCount = 4;
-        float zBuffer;
-        std::vector<QuadVertex> vertices;
+    /**
+     * A range of a prebaked quad mesh, queued and sorted like any other primitive. Drawn on its own at flush,
+     * its single texture bound to slot 1
+     */
+    struct FrameMesh {
+        Ref<VertexArray> Mesh;
+        glm::mat4 Model; // Mesh space to world
+        uint32_t FirstVertex;
+        uint32_t IndexCount;
+        int32_t Shader; // Into Renderer2DData::FrameShaders, -1 for the quad shader
+        int EntityID; // Used by the meshes whose vertices leave the entity ID out
     };
 
     struct Renderer2DData {
+        Renderer2DSpecification Specification;
+
         static const uint32_t MaxQuads = 20000;
         static const uint32_t MaxVertices = MaxQuads * 4;
         static const uint32_t MaxIndices = MaxQuads * 6;
@@ -81,9 +183,12 @@ namespace Shado {
         Ref<VertexBuffer> QuadVertexBuffer;
         Ref<Shader> QuadShader;
         Ref<Texture2D> WhiteTexture;
-        std::vector<QuadFace> transparentQuads;
 
 
+        Ref<VertexArray> QuadInstanceVertexArray;
+        Ref<VertexBuffer> QuadInstanceBuffer;
+        Ref<Shader> QuadInstanceShader;
+
         Ref<VertexArray> CircleVertexArray;
         Ref<VertexBuffer> CircleVertexBuffer;
         Ref<Shader> CircleShader;
@@ -100,11 +205,17 @@ namespace Shado {
         QuadVertex* QuadVertexBufferBase = nullptr;
         QuadVertex* QuadVertexBufferPtr = nullptr;
 
+        uint32_t QuadInstanceCount = 0;
+        QuadInstance* QuadInstanceBufferBase = nullptr;
+        QuadInstance* QuadInstanceBufferPtr = nullptr;
+
         uint32_t CircleIndexCount = 0;
         CircleVertex* CircleVertexBufferBase = nullptr;
         CircleVertex* CircleVertexBufferPtr = nullptr;
 
         uint32_t LineVertexCount = 0;
+        // Mapped on the first line of a scene, lines are not sorted so they are written in place. Quad batches
+        // do not touch it, so the ring only moves to a new section once per scene
         LineVertex* LineVertexBufferBase = nullptr;
         LineVertex* LineVertexBufferPtr = nullptr;
 
@@ -114,41 +225,534 @@ namespace Shado {
 
         float LineWidth = 2.0f;
 
-        std::array<Ref<Texture2D>, MaxTextureSlots> TextureSlots;
-        uint32_t TextureSlotIndex = 1; // 0 = white texture
+        // Draw packet queue, sorted in place and turned into batches at Flush. Each primitive type is capped
+        // at MaxQuads staged quads, so the queue can never hold more than MaxPackets
+        static const uint32_t MaxFrameMeshes = 4096;
+        static const uint32_t MaxPackets = MaxQuads * 4 + MaxFrameMeshes;
+        static const uint32_t MaxFrameTextures = 1 << 12; // Must fit the texture field of the sort key
+        DrawPacket* Packets = nullptr;
+        DrawPacket* PacketScratch = nullptr;
+        uint32_t PacketCount = 0;
+        uint32_t Layer = 0;
+
+        // Every texture referenced by the queued packets. 0 = white texture
+        std::array<Ref<Texture2D>, MaxFrameTextures> FrameTextures;
+        std::array<int32_t, MaxFrameTextures> FrameTextureSlots; // Slot in the current batch, -1 if not bound
+        uint32_t FrameTextureCount = 0;
+
+        // Renderer ID -> FrameTextures index, open addressing. Entries with an old stamp are free,
+        // so the table is cleared by bumping QueueStamp instead of touching it
+        struct FrameTextureEntry {
+            uint32_t RendererID = 0;
+            uint32_t Stamp = 0;
+            uint16_t Index = 0;
+        };
 
-        Ref<Texture2D> FontAtlasTexture;
+        static const uint32_t FrameTextureTableSize = MaxFrameTextures * 2;
+        std::array<FrameTextureEntry, FrameTextureTableSize> FrameTextureTable;
+        uint32_t QueueStamp = 0;
+
+        // AssetHandle -> FrameTextures index, same scheme. Only the first draw of a texture asset in a frame
+        // goes through the AssetManager, the next ones are a single probe without any Ref copy
+        struct FrameTextureHandleEntry {
+            uint64_t Handle = 0;
+            uint32_t Stamp = 0;
+            uint16_t Index = 0; // Of the atlas page when Atlased
+            bool Atlased = false;
+            glm::vec4 AtlasRect;
+        };
+
+        std::array<FrameTextureHandleEntry, FrameTextureTableSize> FrameTextureHandleTable;
+        uint32_t FrameTextureHandleCount = 0;
+
+        // Custom sprite shaders referenced by the queued packets. Few per frame, so a linear search on the
+        // handle is enough and the asset is only fetched the first time a shader shows up
+        static const uint32_t MaxFrameShaders = 256; // Must fit DrawPacket::Shader
+        std::array<AssetHandle, MaxFrameShaders> FrameShaderHandles;
+        std::array<Ref<Shader>, MaxFrameShaders> FrameShaders;
+        uint32_t FrameShaderCount = 0;
+
+        std::vector<FrameMesh> FrameMeshes; // Mesh ranges referenced by the queued packets
+        glm::mat4 ModelMatrix = glm::mat4(1.0f); // Premultiplied into the camera buffer currently uploaded
+
+        // Batch being emitted, mapped from the streaming buffer of its type. Vertices are copied there
+        // in sorted order and the GPU reads them in place
+        QuadVertex* QuadUploadBase = nullptr;
+        QuadVertex* QuadUploadPtr = nullptr;
+        QuadInstance* QuadInstanceUploadBase = nullptr;
+        QuadInstance* QuadInstanceUploadPtr = nullptr;
+        CircleVertex* CircleUploadBase = nullptr;
+        CircleVertex* CircleUploadPtr = nullptr;
+        TextVertex* TextUploadBase = nullptr;
+        TextVertex* TextUploadPtr = nullptr;
+        DrawPacketType BatchType = DrawPacketType::Quad;
+        uint32_t BatchIndexCount = 0;
+        uint16_t BatchFontAtlas = 0;
+        uint8_t BatchShader = 0;
+
+        // Staged primitives already emitted, what is left bounds the size of the next batch to map
+        uint32_t QuadVerticesEmitted = 0;
+        uint32_t QuadInstancesEmitted = 0;
+        uint32_t CircleVerticesEmitted = 0;
+        uint32_t TextVerticesEmitted = 0;
+
+        std::array<uint16_t, MaxTextureSlots> TextureSlots; // FrameTextures index bound to each slot
+        uint32_t TextureSlotIndex = 1; // 0 = white texture
 
         glm::vec4 QuadVertexPositions[4];
 
+        std::vector<QuadVertexData> TilemapVertices; // Scratch buffer reused by the tilemap chunk builds
+
+        // World rectangle of the scene camera, min xy then max xy. Only tested while Culling is set
+        glm::vec4 ViewRect = {0.0f, 0.0f, 0.0f, 0.0f};
+        bool Culling = false;
+
         Renderer2D::Statistics Stats;
 
+        std::deque<Renderer2DRecorder> Recorders; // Deque so references stay valid as workers are added
+
+        // Threads of RecordParallel, thread i runs recorder i + 1. Each dispatch bumps RecordGeneration
+        std::vector<std::thread> RecordThreads;
+        std::mutex RecordMutex;
+        std::condition_variable RecordWake;
+        std::condition_variable RecordDone;
+        const std::function<void(Renderer2DRecorder&, uint32_t)>* RecordJob = nullptr;
+        uint64_t RecordGeneration = 0;
+        uint32_t RecordCount = 0;
+        uint32_t RecordPending = 0;
+        bool RecordRunning = false;
+
         struct CameraData {
             glm::mat4 ViewProjection;
         };
 
         CameraData CameraBuffer;
         Ref<UniformBuffer> CameraUniformBuffer;
+
+        // Engine-global values, std140 layout of the Frame block (binding 1) in the Renderer2D shaders
+        struct FrameData {
+            glm::vec2 ScreenResolution;
+            glm::vec2 MousePos;
+            float Time;
+            float Padding[3];
+        };
+
+        FrameData FrameBuffer;
+        Ref<UniformBuffer> FrameUniformBuffer;
     };
 
     static Renderer2DData s_Data;
 
-    void Renderer2D::Init() {
+    static constexpr uint32_t QuadPipeline = 0;
+    static constexpr uint32_t CirclePipeline = 1;
+    static constexpr uint32_t TextPipeline = 2;
+    static constexpr uint32_t QuadInstancePipeline = 3;
+    static constexpr uint32_t ShaderQuadPipeline = 4; // + FrameShaders index
+    static constexpr uint32_t MeshPipeline = ShaderQuadPipeline + Renderer2DData::MaxFrameShaders; // + Shader + 1
+
+    // Maps a float to an unsigned int with the same ordering
+    static uint32_t SortableDepth(float depth) {
+        uint32_t bits;
+        std::memcpy(&bits, &depth, sizeof(bits));
+        return (bits & 0x80000000u) ? ~bits : bits | 0x80000000u;
+    }
+
+    static uint64_t MakeSortKey(uint32_t pipeline, uint16_t texture, float depth, bool translucent) {
+        const uint64_t layer = (uint64_t)(s_Data.Layer & 0xF) << 60;
+        const uint64_t material = ((uint64_t)(pipeline & 0xFFF) << 12) | (texture & 0xFFF);
+
+        if (translucent)
+            return layer | (1ull << 59) | ((uint64_t)SortableDepth(depth) << 24) | material;
+
+        // Opaque geometry goes front to back (camera looks down -Z) so early depth test rejects the rest
+        return layer | (material << 32) | (uint64_t)~SortableDepth(depth);
+    }
+
+    /**
+     * Stable LSD radix sort on the packet keys, one byte per pass. Passes where every key
+     * shares the same byte are skipped, which is most of them in a typical frame
+     * @return The buffer holding the sorted packets (either packets or scratch)
+     */
+    static DrawPacket* RadixSortPackets(DrawPacket* packets, DrawPacket* scratch, size_t count) {
+        SHADO_PROFILE_FUNCTION();
+
+        DrawPacket* src = packets;
+        DrawPacket* dst = scratch;
+
+        for (uint32_t shift = 0; shift < 64; shift += 8) {
+            size_t histogram[256] = {};
+            for (size_t i = 0; i < count; i++)
+                histogram[(src[i].Key >> shift) & 0xFF]++;
+
+            if (histogram[(src[0].Key >> shift) & 0xFF] == count)
+                continue;
+
+            size_t offset = 0;
+            for (size_t& bucket : histogram) {
+                size_t bucketCount = bucket;
+                bucket = offset;
+                offset += bucketCount;
+            }
+
+            for (size_t i = 0; i < count; i++)
+                dst[histogram[(src[i].Key >> shift) & 0xFF]++] = src[i];
+
+            std::swap(src, dst);
+        }
+
+        return src;
+    }
+
+    static uint16_t GetFrameTextureIndex(const Ref<Texture2D>& texture) {
+        // Streamed textures draw white until their pixels are resident
+        if (!texture->isLoaded())
+            return 0;
+
+        const uint32_t rendererID = texture->getRendererID();
+        uint32_t bucket = (rendererID * 2654435761u) & (Renderer2DData::FrameTextureTableSize - 1);
+
+        // At most MaxFrameTextures entries live in a table twice that size, so there is always a free bucket
+        while (true) {
+            auto& entry = s_Data.FrameTextureTable[bucket];
+            if (entry.Stamp != s_Data.QueueStamp) {
+                uint16_t index = (uint16_t)s_Data.FrameTextureCount++;
+                s_Data.FrameTextures[index] = texture;
+                s_Data.FrameTextureSlots[index] = -1;
+                entry = {rendererID, s_Data.QueueStamp, index};
+                return index;
+            }
+
+            if (entry.RendererID == rendererID)
+                return entry.Index;
+
+            bucket = (bucket + 1) & (Renderer2DData::FrameTextureTableSize - 1);
+        }
+    }
+
+    static uint16_t ResolveFrameTextureEntry(const Renderer2DData::FrameTextureHandleEntry& entry,
+                                             glm::vec4* uvRect) {
+        if (!entry.Atlased)
+            return entry.Index;
+
+        if (uvRect) {
+            *uvRect = SpriteAtlas::ComposeUVRect(entry.AtlasRect, *uvRect);
+            return entry.Index;
+        }
+
+        // The caller cannot remap its UVs (tiling, circles, custom shaders), fall back to the standalone texture
+        Ref<Texture2D> texture = AssetManager::GetAsset<Texture2D>(entry.Handle);
+        return texture ? GetFrameTextureIndex(texture) : (uint16_t)0;
+    }
+
+    /**
+     * @param uvRect When not null and the texture was packed into the sprite atlas, the UV rect (min xy, max zw)
+     * is mapped into the atlas page and the page is returned instead
+     * @return The FrameTextures index of a texture asset. Textures that fail to load draw white
+     */
+    static uint16_t GetFrameTextureIndex(AssetHandle textureHandle, glm::vec4* uvRect = nullptr) {
+        const uint64_t handle = textureHandle;
+        uint32_t bucket = (uint32_t)((handle * 0x9E3779B97F4A7C15ull) >> 40) &
+            (Renderer2DData::FrameTextureTableSize - 1);
+
+        while (true) {
+            auto& entry = s_Data.FrameTextureHandleTable[bucket];
+            if (entry.Stamp != s_Data.QueueStamp) {
+                const SpriteAtlas* atlas = AssetManager::GetSpriteAtlas();
+                const SpriteAtlasRegion* region = atlas ? atlas->findRegion(textureHandle) : nullptr;
+                if (region) {
+                    entry = {
+                        handle, s_Data.QueueStamp, GetFrameTextureIndex(atlas->getPage(region->Page)), true,
+                        region->UVRect
+                    };
+                }
+                else {
+                    Ref<Texture2D> texture = AssetManager::GetAsset<Texture2D>(textureHandle);
+                    entry = {handle, s_Data.QueueStamp, texture ? GetFrameTextureIndex(texture) : (uint16_t)0};
+                }
+                s_Data.FrameTextureHandleCount++;
+                return ResolveFrameTextureEntry(entry, uvRect);
+            }
+
+            if (entry.Handle == handle)
+                return ResolveFrameTextureEntry(entry, uvRect);
+
+            bucket = (bucket + 1) & (Renderer2DData::FrameTextureTableSize - 1);
+        }
+    }
+
+    // Both texture tables must have room for one more texture before resolving one
+    static bool FrameTexturesFull() {
+        return s_Data.FrameTextureCount >= Renderer2DData::MaxFrameTextures ||
+            s_Data.FrameTextureHandleCount >= Renderer2DData::MaxFrameTextures;
+    }
+
+    static constexpr uint32_t TimeUniform = Shader::HashUniformName("u_Time");
+    static constexpr uint32_t ScreenResolutionUniform = Shader::HashUniformName("u_ScreenResolution");
+    static constexpr uint32_t MousePosUniform = Shader::HashUniformName("u_MousePos");
+
+    static void UploadFrameData() {
+        s_Data.FrameBuffer.ScreenResolution = {
+            Application::get().getWindow().getWidth(), Application::get().getWindow().getHeight()
+        };
+        s_Data.FrameBuffer.MousePos = {Input::getMouseX(), Input::getMouseY()};
+        s_Data.FrameBuffer.Time = (float)glfwGetTime();
+        s_Data.FrameUniformBuffer->setData(&s_Data.FrameBuffer, sizeof(Renderer2DData::FrameData));
+    }
+
+    /**
+     * @return The FrameShaders index of the shader, or -1 if the handle does not resolve to a shader
+     */
+    static int32_t GetFrameShaderIndex(AssetHandle shaderHandle) {
+        for (uint32_t i = 0; i < s_Data.FrameShaderCount; i++) {
+            if (s_Data.FrameShaderHandles[i] == shaderHandle)
+                return (int32_t)i;
+        }
+
+        // A shader still linking asynchronously draws with the default quad shader until it is ready
+        Ref<Shader> shader = AssetManager::GetAsset<Shader>(shaderHandle);
+        if (!shader || !shader->isReady())
+            return -1;
+
+        uint32_t index = s_Data.FrameShaderCount++;
+        s_Data.FrameShaderHandles[index] = shaderHandle;
+        s_Data.FrameShaders[index] = shader;
+
+        // Older project shaders declare the frame values as plain uniforms instead of the Frame block.
+        // They are set once here when the shader enters the frame table rather than on every flush
+        if (shader->hasUniform(TimeUniform))
+            shader->setFloat(TimeUniform, s_Data.FrameBuffer.Time);
+        if (shader->hasUniform(ScreenResolutionUniform))
+            shader->setFloat2(ScreenResolutionUniform, s_Data.FrameBuffer.ScreenResolution);
+        if (shader->hasUniform(MousePosUniform))
+            shader->setFloat2(MousePosUniform, s_Data.FrameBuffer.MousePos);
+        return (int32_t)index;
+    }
+
+    // Vertex generation only reads s_Data constants, so it is shared with the recorders on worker threads
+    static constexpr glm::vec4 FullUVRect = {0.0f, 0.0f, 1.0f, 1.0f};
+
+    /**
+     * Positions of the unit quad corners under a transform. The corners are +-0.5 on x and y, so each one is the
+     * translation plus or minus half of the first two columns, instead of a full matrix product per corner.
+     * Must run before the other attributes are written, the SSE path spills into Color
+     */
+    static void WriteQuadCorners(QuadVertex* vertices, const glm::mat4& transform) {
+#if SHADO_RENDERER2D_SSE2
+        const __m128 half = _mm_set1_ps(0.5f);
+        const __m128 x = _mm_mul_ps(_mm_loadu_ps(&transform[0].x), half);
+        const __m128 y = _mm_mul_ps(_mm_loadu_ps(&transform[1].x), half);
+        const __m128 translation = _mm_loadu_ps(&transform[3].x);
+        const __m128 bottom = _mm_sub_ps(translation, y);
+        const __m128 top = _mm_add_ps(translation, y);
+
+        // 16 byte stores, the w lane lands on Color
+        _mm_storeu_ps(&vertices[0].Position.x, _mm_sub_ps(bottom, x));
+        _mm_storeu_ps(&vertices[1].Position.x, _mm_add_ps(bottom, x));
+        _mm_storeu_ps(&vertices[2].Position.x, _mm_add_ps(top, x));
+        _mm_storeu_ps(&vertices[3].Position.x, _mm_sub_ps(top, x));
+#else
+        for (size_t i = 0; i < 4; i++)
+            vertices[i].Position = transform * s_Data.QuadVertexPositions[i];
+#endif
+    }
+
+    // Everything but the positions. TexIndex is resolved when the packet is emitted into a batch
+    static void WriteQuadAttributes(QuadVertex* vertices, const glm::vec4& color, float tilingFactor, int entityID,
+                                    const glm::vec4& uvRect) {
+        const glm::vec2 textureCoords[] = {
+            {uvRect.x, uvRect.y}, {uvRect.z, uvRect.y}, {uvRect.z, uvRect.w}, {uvRect.x, uvRect.w}
+        };
+
+        for (size_t i = 0; i < 4; i++) {
+            vertices[i].Color = color;
+            vertices[i].TexCoord = textureCoords[i];
+            vertices[i].TexIndex = 0.0f;
+            vertices[i].TilingFactor = tilingFactor;
+            vertices[i].setEntityID(entityID);
+        }
+    }
+
+    static void WriteQuadVertices(QuadVertex* vertices, const glm::mat4& transform, const glm::vec4& color,
+                                  float tilingFactor, int entityID, const glm::vec4& uvRect = FullUVRect) {
+        WriteQuadCorners(vertices, transform);
+        WriteQuadAttributes(vertices, color, tilingFactor, entityID, uvRect);
+    }
+
+    // Out of plane rotations do not fit the 2D affine record, those quads take the vertex path
+    static bool UseQuadInstance(const glm::mat4& transform) {
+        return s_Data.Specification.InstancedQuads && transform[0].z == 0.0f && transform[1].z == 0.0f;
+    }
+
+    static void WriteQuadInstance(QuadInstance& instance, const glm::mat4& transform, const glm::vec4& color,
+                                  float tilingFactor, int entityID, const glm::vec4& uvRect = FullUVRect) {
+        instance.Transform = {transform[0].x, transform[0].y, transform[1].x, transform[1].y};
+        instance.Translation = transform[3];
+        instance.Color = glm::packUnorm4x8(color);
+        instance.TexRect = uvRect * tilingFactor;
+        instance.TexIndex = 0;
+        instance.setEntityID(entityID);
+    }
+
+    /**
+     * Queues a quad and hands out its four staged vertices for the caller to fill. The caller checks capacity
+     */
+    static QuadVertex* PushQuadPacket(uint32_t pipeline, uint16_t frameTexture, float depth, bool translucent,
+                                      DrawPacketType type = DrawPacketType::Quad, uint8_t shader = 0) {
+        QuadVertex* vertices = s_Data.QuadVertexBufferPtr;
+        s_Data.Packets[s_Data.PacketCount++] = {
+            MakeSortKey(pipeline, frameTexture, depth, translucent),
+            (uint32_t)(vertices - s_Data.QuadVertexBufferBase), frameTexture, type, shader
+        };
+
+        s_Data.QuadVertexBufferPtr += 4;
+        s_Data.QuadIndexCount += 6;
+        s_Data.Stats.QuadCount++;
+        return vertices;
+    }
+
+    static QuadInstance& PushQuadInstancePacket(uint16_t frameTexture, float depth, bool translucent) {
+        s_Data.Packets[s_Data.PacketCount++] = {
+            MakeSortKey(QuadInstancePipeline, frameTexture, depth, translucent),
+            s_Data.QuadInstanceCount, frameTexture, DrawPacketType::QuadInstance
+        };
+
+        s_Data.QuadInstanceCount++;
+        s_Data.Stats.QuadCount++;
+        return *s_Data.QuadInstanceBufferPtr++;
+    }
+
+    // Meshes baked in their own space are drawn with the camera premultiplied by their model matrix
+    static void SetModelMatrix(const glm::mat4& model) {
+        if (model == s_Data.ModelMatrix)
+            return;
+
+        s_Data.ModelMatrix = model;
+        const Renderer2DData::CameraData camera = {s_Data.CameraBuffer.ViewProjection * model};
+        s_Data.CameraUniformBuffer->setData(&camera, sizeof(Renderer2DData::CameraData));
+    }
+
+    // Whether PushMeshPacket has room for one more mesh, texture and custom shader
+    static bool FrameMeshesFull() {
+        return s_Data.FrameMeshes.size() >= Renderer2DData::MaxFrameMeshes || FrameTexturesFull() ||
+            s_Data.FrameShaderCount >= Renderer2DData::MaxFrameShaders;
+    }
+
+    /**
+     * Queues quadCount quads of a baked mesh, starting at firstVertex. The caller checks capacity
+     * @param texture Bound to slot 1, white when null or not resident yet
+     */
+    static void PushMeshPacket(const Ref<VertexArray>& mesh, const glm::mat4& model, uint32_t firstVertex,
+                               uint32_t quadCount, const Ref<Texture2D>& texture, AssetHandle shaderHandle,
+                               float depth, bool translucent, int entityID = -1) {
+        const uint16_t frameTexture = texture ? GetFrameTextureIndex(texture) : (uint16_t)0;
+        const int32_t shader = shaderHandle ? GetFrameShaderIndex(shaderHandle) : -1;
+
+        s_Data.Packets[s_Data.PacketCount++] = {
+            MakeSortKey(MeshPipeline + (uint32_t)(shader + 1), frameTexture, depth, translucent),
+            (uint32_t)s_Data.FrameMeshes.size(), frameTexture, DrawPacketType::Mesh
+        };
+        s_Data.FrameMeshes.push_back({mesh, model, firstVertex, quadCount * 6, shader, entityID});
+        s_Data.Stats.QuadCount += quadCount;
+    }
+
+    // Queues a quad on the instanced or vertex path. The caller checks capacity
+    static void PushQuad(const glm::mat4& transform, const glm::vec4& color, uint16_t frameTexture,
+                         float tilingFactor, int entityID, bool translucent, const glm::vec4& uvRect) {
+        if (UseQuadInstance(transform)) {
+            WriteQuadInstance(PushQuadInstancePacket(frameTexture, transform[3].z, translucent), transform, color,
+                              tilingFactor, entityID, uvRect);
+            return;
+        }
+
+        WriteQuadVertices(PushQuadPacket(QuadPipeline, frameTexture, transform[3].z, translucent), transform, color,
+                          tilingFactor, entityID, uvRect);
+    }
+
+    /**
+     * Transforms of four QuadBatch quads, one quad per SSE lane. Lanes past the end of the batch are padding
+     */
+    struct QuadBatchLanes {
+        alignas(16) float AxisX[4], AxisY[4]; // Column 0 of each transform (scaled and rotated x axis)
+        alignas(16) float UpX[4], UpY[4]; // Column 1
+        alignas(16) float CornerX[4][4], CornerY[4][4]; // [corner][lane], same corner order as QuadVertexPositions
+    };
+
+    static void ComputeQuadBatchLanes(const QuadBatch& quads, size_t first, size_t lanes, QuadBatchLanes& out) {
+        alignas(16) float positionX[4] = {}, positionY[4] = {}, sizeX[4] = {}, sizeY[4] = {};
+        alignas(16) float cosines[4] = {1.0f, 1.0f, 1.0f, 1.0f}, sines[4] = {};
+        for (size_t lane = 0; lane < lanes; lane++) {
+            positionX[lane] = quads.PositionX[first + lane];
+            positionY[lane] = quads.PositionY[first + lane];
+            sizeX[lane] = quads.SizeX[first + lane];
+            sizeY[lane] = quads.SizeY[first + lane];
+            if (!quads.Rotation.empty()) {
+                cosines[lane] = std::cos(quads.Rotation[first + lane]);
+                sines[lane] = std::sin(quads.Rotation[first + lane]);
+            }
+        }
+
+#if SHADO_RENDERER2D_SSE2
+        const __m128 cosine = _mm_load_ps(cosines);
+        const __m128 sine = _mm_load_ps(sines);
+        const __m128 width = _mm_load_ps(sizeX);
+        const __m128 height = _mm_load_ps(sizeY);
+
+        const __m128 axisX = _mm_mul_ps(cosine, width);
+        const __m128 axisY = _mm_mul_ps(sine, width);
+        const __m128 upX = _mm_mul_ps(_mm_sub_ps(_mm_setzero_ps(), sine), height);
+        const __m128 upY = _mm_mul_ps(cosine, height);
+        _mm_store_ps(out.AxisX, axisX);
+        _mm_store_ps(out.AxisY, axisY);
+        _mm_store_ps(out.UpX, upX);
+        _mm_store_ps(out.UpY, upY);
+
+        const __m128 half = _mm_set1_ps(0.5f);
+        const __m128 halfAxisX = _mm_mul_ps(axisX, half);
+        const __m128 halfAxisY = _mm_mul_ps(axisY, half);
+        const __m128 halfUpX = _mm_mul_ps(upX, half);
+        const __m128 halfUpY = _mm_mul_ps(upY, half);
+
+        const __m128 x = _mm_load_ps(positionX);
+        const __m128 y = _mm_load_ps(positionY);
+        const __m128 bottomX = _mm_sub_ps(x, halfUpX);
+        const __m128 bottomY = _mm_sub_ps(y, halfUpY);
+        const __m128 topX = _mm_add_ps(x, halfUpX);
+        const __m128 topY = _mm_add_ps(y, halfUpY);
+
+        _mm_store_ps(out.CornerX[0], _mm_sub_ps(bottomX, halfAxisX));
+        _mm_store_ps(out.CornerY[0], _mm_sub_ps(bottomY, halfAxisY));
+        _mm_store_ps(out.CornerX[1], _mm_add_ps(bottomX, halfAxisX));
+        _mm_store_ps(out.CornerY[1], _mm_add_ps(bottomY, halfAxisY));
+        _mm_store_ps(out.CornerX[2], _mm_add_ps(topX, halfAxisX));
+        _mm_store_ps(out.CornerY[2], _mm_add_ps(topY, halfAxisY));
+        _mm_store_ps(out.CornerX[3], _mm_sub_ps(topX, halfAxisX));
+        _mm_store_ps(out.CornerY[3], _mm_sub_ps(topY, halfAxisY));
+#else
+        for (size_t lane = 0; lane < 4; lane++) {
+            out.AxisX[lane] = cosines[lane] * sizeX[lane];
+            out.AxisY[lane] = sines[lane] * sizeX[lane];
+            out.UpX[lane] = -sines[lane] * sizeY[lane];
+            out.UpY[lane] = cosines[lane] * sizeY[lane];
+
+            for (size_t corner = 0; corner < 4; corner++) {
+                const glm::vec4& unit = s_Data.QuadVertexPositions[corner];
+                out.CornerX[corner][lane] = positionX[lane] + unit.x * out.AxisX[lane] + unit.y * out.UpX[lane];
+                out.CornerY[corner][lane] = positionY[lane] + unit.x * out.AxisY[lane] + unit.y * out.UpY[lane];
+            }
+        }
+#endif
+    }
+
+    void Renderer2D::Init(const Renderer2DSpecification& specification) {
         SHADO_PROFILE_FUNCTION();
 
         s_Init = true;
+        s_Data.Specification = specification;
 
         s_Data.QuadVertexArray = VertexArray::create();
 
-        s_Data.QuadVertexBuffer = VertexBuffer::create(s_Data.MaxVertices * sizeof(QuadVertex));
-        s_Data.QuadVertexBuffer->setLayout({
-            {ShaderDataType::Float3, "a_Position"},
-            {ShaderDataType::Float4, "a_Color"},
-            {ShaderDataType::Float2, "a_TexCoord"},
-            {ShaderDataType::Float, "a_TexIndex"},
-            {ShaderDataType::Float, "a_TilingFactor"},
-            {ShaderDataType::Int, "a_EntityID"}
-        });
+        s_Data.QuadVertexBuffer = VertexBuffer::createStreaming(s_Data.MaxVertices * sizeof(QuadVertex));
+        s_Data.QuadVertexBuffer->setLayout(QuadVertexLayout());
         s_Data.QuadVertexArray->addVertexBuffer(s_Data.QuadVertexBuffer);
 
         s_Data.QuadVertexBufferBase = Memory::Heap<QuadVertex>(s_Data.MaxVertices, "Renderer2D");
@@ -172,21 +776,37 @@ namespace Shado {
         s_Data.QuadVertexArray->setIndexBuffer(quadIB);
         Memory::Free(quadIndices);
 
+        // Instanced quads. Only the first 6 indices of the quad IB are used, gl_VertexID picks the corner
+        if (s_Data.Specification.InstancedQuads) {
+            s_Data.QuadInstanceVertexArray = VertexArray::create();
+            s_Data.QuadInstanceBuffer = VertexBuffer::createStreaming(s_Data.MaxQuads * sizeof(QuadInstance));
+            s_Data.QuadInstanceBuffer->setLayout(MakeVertexLayout({
+                {ShaderDataType::Float4, "a_Transform"},
+                {ShaderDataType::Float3, "a_Translation"},
+                {ShaderDataType::Int, "a_Color"},
+                {ShaderDataType::Float4, "a_TexRect"},
+                {ShaderDataType::Int, "a_TexIndex"}
+            }, 1));
+            s_Data.QuadInstanceVertexArray->addVertexBuffer(s_Data.QuadInstanceBuffer);
+            s_Data.QuadInstanceVertexArray->setIndexBuffer(quadIB);
+
+            s_Data.QuadInstanceBufferBase = Memory::Heap<QuadInstance>(s_Data.MaxQuads, "Renderer2D");
+        }
+
         // Circles
         s_Data.CircleVertexArray = VertexArray::create();
 
-        s_Data.CircleVertexBuffer = VertexBuffer::create(s_Data.MaxVertices * sizeof(CircleVertex));
-        s_Data.CircleVertexBuffer->setLayout({
+        s_Data.CircleVertexBuffer = VertexBuffer::createStreaming(s_Data.MaxVertices * sizeof(CircleVertex));
+        s_Data.CircleVertexBuffer->setLayout(MakeVertexLayout({
             {ShaderDataType::Float3, "a_WorldPosition"},
-            {ShaderDataType::Float3, "a_LocalPosition"},
-            {ShaderDataType::Float4, "a_Color"},
-            {ShaderDataType::Float, "a_Thickness"},
-            {ShaderDataType::Float, "a_Fade"},
-            {ShaderDataType::Int, "a_EntityID"},
-            {ShaderDataType::Float2, "a_TexCoord"},
-            {ShaderDataType::Float, "a_TexIndex"},
-            {ShaderDataType::Float, "a_TilingFactor"}
-        });
+            {ShaderDataType::Half2, "a_LocalPosition"},
+            {ShaderDataType::UByte4, "a_Color", true},
+            {ShaderDataType::Half, "a_Thickness"},
+            {ShaderDataType::Half, "a_Fade"},
+            {ShaderDataType::UShort2, "a_TexCoord", true},
+            {ShaderDataType::Half, "a_TexIndex"},
+            {ShaderDataType::Half, "a_TilingFactor"}
+        }));
         s_Data.CircleVertexArray->addVertexBuffer(s_Data.CircleVertexBuffer);
         s_Data.CircleVertexArray->setIndexBuffer(quadIB); // Use quad IB
         s_Data.CircleVertexBufferBase = Memory::Heap<CircleVertex>(s_Data.MaxVertices);
@@ -194,28 +814,29 @@ namespace Shado {
         // Lines
         s_Data.LineVertexArray = VertexArray::create();
 
-        s_Data.LineVertexBuffer = VertexBuffer::create(s_Data.MaxVertices * sizeof(LineVertex));
-        s_Data.LineVertexBuffer->setLayout({
+        s_Data.LineVertexBuffer = VertexBuffer::createStreaming(s_Data.MaxVertices * sizeof(LineVertex));
+        s_Data.LineVertexBuffer->setLayout(MakeVertexLayout({
             {ShaderDataType::Float3, "a_Position"},
-            {ShaderDataType::Float4, "a_Color"},
-            {ShaderDataType::Int, "a_EntityID"}
-        });
+            {ShaderDataType::UByte4, "a_Color", true}
+        }));
         s_Data.LineVertexArray->addVertexBuffer(s_Data.LineVertexBuffer);
-        s_Data.LineVertexBufferBase = Memory::Heap<LineVertex>(s_Data.MaxVertices, "Renderer2D");
 
         // Text
         s_Data.TextVertexArray = VertexArray::create();
-        s_Data.TextVertexBuffer = VertexBuffer::create(s_Data.MaxVertices * sizeof(TextVertex));
-        s_Data.TextVertexBuffer->setLayout({
+        s_Data.TextVertexBuffer = VertexBuffer::createStreaming(s_Data.MaxVertices * sizeof(TextVertex));
+        s_Data.TextVertexBuffer->setLayout(MakeVertexLayout({
             {ShaderDataType::Float3, "a_Position"},
-            {ShaderDataType::Float4, "a_Color"},
-            {ShaderDataType::Float2, "a_TexCoord"},
-            {ShaderDataType::Int, "a_EntityID"}
-        });
+            {ShaderDataType::UByte4, "a_Color", true},
+            {ShaderDataType::UShort2, "a_TexCoord", true}
+        }));
         s_Data.TextVertexArray->addVertexBuffer(s_Data.TextVertexBuffer);
         s_Data.TextVertexArray->setIndexBuffer(quadIB);
         s_Data.TextVertexBufferBase = new TextVertex[s_Data.MaxVertices];
 
+        s_Data.Packets = Memory::Heap<DrawPacket>(s_Data.MaxPackets, "Renderer2D");
+        s_Data.FrameMeshes.reserve(Renderer2DData::MaxFrameMeshes);
+        s_Data.PacketScratch = Memory::Heap<DrawPacket>(s_Data.MaxPackets, "Renderer2D");
+
 
         s_Data.WhiteTexture = snew(Texture2D) Texture2D(1, 1);
         uint32_t whiteTextureData = 0xffffffff;
@@ -229,16 +850,19 @@ namespace Shado {
         s_Data.CircleShader = ShaderImporter::LoadShader("assets/shaders/Renderer2D_Circle.glsl");
         s_Data.LineShader = ShaderImporter::LoadShader("assets/shaders/Renderer2D_Line.glsl");
         s_Data.TextShader = ShaderImporter::LoadShader("assets/shaders/Renderer2D_Text.glsl");
+        if (s_Data.Specification.InstancedQuads)
+            s_Data.QuadInstanceShader = ShaderImporter::LoadShader(QUAD_INSTANCED_SHADER);
 
         // Set first texture slot to 0
-        s_Data.TextureSlots[0] = s_Data.WhiteTexture;
+        s_Data.TextureSlots[0] = 0;
 
         s_Data.QuadVertexPositions[0] = {-0.5f, -0.5f, 0.0f, 1.0f};
         s_Data.QuadVertexPositions[1] = {0.5f, -0.5f, 0.0f, 1.0f};
         s_Data.QuadVertexPositions[2] = {0.5f, 0.5f, 0.0f, 1.0f};
         s_Data.QuadVertexPositions[3] = {-0.5f, 0.5f, 0.0f, 1.0f};
 
-        s_Data.CameraUniformBuffer = UniformBuffer::create(sizeof(Renderer2DData::CameraData), 0);
+        s_Data.CameraUniformBuffer = UniformBuffer::createStreaming(sizeof(Renderer2DData::CameraData), 0);
+        s_Data.FrameUniformBuffer = UniformBuffer::createStreaming(sizeof(Renderer2DData::FrameData), 1);
 
         glEnable(GL_BLEND);
         glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
@@ -279,6 +903,30 @@ namespace Shado {
         SHADO_PROFILE_FUNCTION();
 
         Memory::Free(s_Data.QuadVertexBufferBase);
+        Memory::Free(s_Data.CircleVertexBufferBase);
+        delete[] s_Data.TextVertexBufferBase;
+        Memory::Free(s_Data.Packets);
+        Memory::Free(s_Data.PacketScratch);
+        s_Data.FrameTextures.fill(nullptr);
+        s_Data.FrameShaders.fill(nullptr);
+        s_Data.FrameMeshes.clear();
+
+        {
+            std::lock_guard<std::mutex> lock(s_Data.RecordMutex);
+            s_Data.RecordRunning = false;
+        }
+        s_Data.RecordWake.notify_all();
+        for (std::thread& thread : s_Data.RecordThreads)
+            thread.join();
+        s_Data.RecordThreads.clear();
+        s_Data.Recorders.clear();
+
+        if (s_Data.QuadInstanceBufferBase) {
+            Memory::Free(s_Data.QuadInstanceBufferBase);
+            s_Data.QuadInstanceBufferBase = nullptr;
+        }
+
+        s_Init = false;
     }
 
     void Renderer2D::BeginScene(const Camera& camera) {
@@ -286,7 +934,11 @@ namespace Shado {
 
         s_Data.CameraBuffer.ViewProjection = camera.getViewProjectionMatrix();
         s_Data.CameraUniformBuffer->setData(&s_Data.CameraBuffer, sizeof(Renderer2DData::CameraData));
+        s_Data.ModelMatrix = glm::mat4(1.0f);
+        UploadFrameData();
 
+        s_Data.Layer = 0;
+        s_Data.Culling = false;
         StartBatch();
     }
 
@@ -295,10 +947,29 @@ namespace Shado {
 
         s_Data.CameraBuffer.ViewProjection = camera.getProjectionMatrix() * glm::inverse(transform);
         s_Data.CameraUniformBuffer->setData(&s_Data.CameraBuffer, sizeof(Renderer2DData::CameraData));
+        s_Data.ModelMatrix = glm::mat4(1.0f);
+        UploadFrameData();
 
+        s_Data.Layer = 0;
+        s_Data.Culling = false;
         StartBatch();
     }
 
+    void Renderer2D::SetCullingDepthRange(float minZ, float maxZ) {
+        s_Data.ViewRect = ViewCulling::GetViewRect(s_Data.CameraBuffer.ViewProjection, minZ, maxZ);
+        s_Data.Culling = true;
+    }
+
+    bool Renderer2D::IsVisible(const glm::vec4& bounds) {
+        if (!s_Data.Culling || ViewCulling::Overlaps(bounds, s_Data.ViewRect)) {
+            s_Data.Stats.VisibleCount++;
+            return true;
+        }
+
+        s_Data.Stats.CulledCount++;
+        return false;
+    }
+
     void Renderer2D::EndScene() {
         SHADO_PROFILE_FUNCTION();
 
@@ -311,92 +982,287 @@ namespace Shado {
         s_Data.QuadIndexCount = 0;
         s_Data.QuadVertexBufferPtr = s_Data.QuadVertexBufferBase;
 
+        s_Data.QuadInstanceCount = 0;
+        s_Data.QuadInstanceBufferPtr = s_Data.QuadInstanceBufferBase;
+
         s_Data.CircleIndexCount = 0;
         s_Data.CircleVertexBufferPtr = s_Data.CircleVertexBufferBase;
 
-        s_Data.LineVertexCount = 0;
-        s_Data.LineVertexBufferPtr = s_Data.LineVertexBufferBase;
-
         s_Data.TextIndexCount = 0;
         s_Data.TextVertexBufferPtr = s_Data.TextVertexBufferBase;
 
+        // Nothing is freed here, the arenas and the texture table are reused as is
+        s_Data.PacketCount = 0;
+        s_Data.FrameTextureCount = 0;
+        s_Data.FrameTextureHandleCount = 0;
+        s_Data.QueueStamp++;
+        GetFrameTextureIndex(s_Data.WhiteTexture);
+        s_Data.FrameTextureSlots[0] = 0;
+        s_Data.FrameShaderCount = 0;
+        s_Data.FrameMeshes.clear();
+
+        s_Data.QuadVerticesEmitted = 0;
+        s_Data.QuadInstancesEmitted = 0;
+        s_Data.CircleVerticesEmitted = 0;
+        s_Data.TextVerticesEmitted = 0;
+        s_Data.BatchIndexCount = 0;
         s_Data.TextureSlotIndex = 1;
     }
 
     void Renderer2D::Flush() {
-        if (s_Data.QuadIndexCount) {
-            // This is here because when batch rendering, OpenGL depth test does not work
-            // as intended
-            if (CPUAlphaZSorting) {
-                // Sort transparent objects by Z
-                std::sort(s_Data.transparentQuads.begin(), s_Data.transparentQuads.end(), [](QuadFace& a, QuadFace& b) {
-                    return a.zBuffer < b.zBuffer;
-                });
-                // Add the transparent objects to the end of the array
-                for (const auto& face : s_Data.transparentQuads) {
-                    for (size_t i = 0; i < face.vertexCount; i++) {
-                        *s_Data.QuadVertexBufferPtr = face.vertices[i];
-                        s_Data.QuadVertexBufferPtr++;
-                    }
-                }
-                s_Data.transparentQuads.clear();
-            }
+        FlushPackets();
+        FlushLines();
+    }
 
-            uint32_t dataSize = (uint32_t)((uint8_t*)s_Data.QuadVertexBufferPtr - (uint8_t*)s_Data.
-                QuadVertexBufferBase);
-            s_Data.QuadVertexBuffer->setData(s_Data.QuadVertexBufferBase, dataSize);
+    void Renderer2D::FlushPackets() {
+        SHADO_PROFILE_FUNCTION();
 
-            // Bind textures
-            for (uint32_t i = 0; i < s_Data.TextureSlotIndex; i++)
-                s_Data.TextureSlots[i]->bind(i);
-
-            s_Data.QuadShader->bind();
-            s_Data.QuadShader->setFloat("u_Time", (float)glfwGetTime());
-            s_Data.QuadShader->setFloat2("u_ScreenResolution", {
-                                             Application::get().getWindow().getWidth(),
-                                             Application::get().getWindow().getHeight()
-                                         });
-            s_Data.QuadShader->setFloat2("u_MousePos", {Input::getMouseX(), Input::getMouseY()});
-            CmdDrawIndexed(s_Data.QuadVertexArray, s_Data.QuadIndexCount);
-            s_Data.Stats.DrawCalls++;
-        }
+        if (s_Data.PacketCount) {
+            const DrawPacket* sorted = RadixSortPackets(s_Data.Packets, s_Data.PacketScratch, s_Data.PacketCount);
 
-        if (s_Data.CircleIndexCount) {
-            uint32_t dataSize = (uint32_t)((uint8_t*)s_Data.CircleVertexBufferPtr - (uint8_t*)s_Data.
-                CircleVertexBufferBase);
-            s_Data.CircleVertexBuffer->setData(s_Data.CircleVertexBufferBase, dataSize);
+            for (uint32_t i = 0; i < s_Data.PacketCount; i++)
+                EmitPacket(sorted[i]);
 
-            s_Data.CircleShader->bind();
-            CmdDrawIndexed(s_Data.CircleVertexArray, s_Data.CircleIndexCount);
-            s_Data.Stats.DrawCalls++;
+            FlushBatch();
+            s_Data.PacketCount = 0;
         }
 
+        SetModelMatrix(glm::mat4(1.0f));
+    }
+
+    void Renderer2D::StartLineBatch() {
+        s_Data.LineVertexCount = 0;
+        s_Data.LineVertexBufferBase = (LineVertex*)s_Data.LineVertexBuffer->map(
+            Renderer2DData::MaxVertices * sizeof(LineVertex));
+        s_Data.LineVertexBufferPtr = s_Data.LineVertexBufferBase;
+    }
+
+    void Renderer2D::FlushLines() {
+        SHADO_PROFILE_FUNCTION();
+
         if (s_Data.LineVertexCount) {
             uint32_t dataSize = (uint32_t)((uint8_t*)s_Data.LineVertexBufferPtr - (uint8_t*)s_Data.
                 LineVertexBufferBase);
-            s_Data.LineVertexBuffer->setData(s_Data.LineVertexBufferBase, dataSize);
+            uint32_t offset = s_Data.LineVertexBuffer->commit(dataSize);
+            s_Data.Stats.UploadedBytes += dataSize;
 
             s_Data.LineShader->bind();
             //RenderCommand::SetLineWidth(s_Data.LineWidth);
-            CmdDrawIndexedLine(s_Data.LineVertexArray, s_Data.LineVertexCount);
+            CmdDrawIndexedLine(s_Data.LineVertexArray, s_Data.LineVertexCount, offset / sizeof(LineVertex));
             s_Data.Stats.DrawCalls++;
         }
 
-        if (s_Data.TextIndexCount) {
-            uint32_t dataSize = (uint32_t)((uint8_t*)s_Data.TextVertexBufferPtr - (uint8_t*)s_Data.
-                TextVertexBufferBase);
-            s_Data.TextVertexBuffer->setData(s_Data.TextVertexBufferBase, dataSize);
+        // The mapping is only valid until the commit, the next line maps again
+        s_Data.LineVertexCount = 0;
+        s_Data.LineVertexBufferBase = nullptr;
+        s_Data.LineVertexBufferPtr = nullptr;
+    }
+
+    void Renderer2D::MapBatch(DrawPacketType type) {
+        // Reserve room for every staged primitive of the buffer not emitted yet, no batch can be bigger
+        switch (type) {
+        case DrawPacketType::Quad:
+        case DrawPacketType::ShaderQuad: {
+            uint32_t remaining = (uint32_t)(s_Data.QuadVertexBufferPtr - s_Data.QuadVertexBufferBase) -
+                s_Data.QuadVerticesEmitted;
+            s_Data.QuadUploadBase = (QuadVertex*)s_Data.QuadVertexBuffer->map(remaining * sizeof(QuadVertex));
+            s_Data.QuadUploadPtr = s_Data.QuadUploadBase;
+            break;
+        }
+        case DrawPacketType::QuadInstance: {
+            uint32_t remaining = s_Data.QuadInstanceCount - s_Data.QuadInstancesEmitted;
+            s_Data.QuadInstanceUploadBase = (QuadInstance*)s_Data.QuadInstanceBuffer->map(
+                remaining * sizeof(QuadInstance));
+            s_Data.QuadInstanceUploadPtr = s_Data.QuadInstanceUploadBase;
+            break;
+        }
+        case DrawPacketType::Circle: {
+            uint32_t remaining = (uint32_t)(s_Data.CircleVertexBufferPtr - s_Data.CircleVertexBufferBase) -
+                s_Data.CircleVerticesEmitted;
+            s_Data.CircleUploadBase = (CircleVertex*)s_Data.CircleVertexBuffer->map(remaining * sizeof(CircleVertex));
+            s_Data.CircleUploadPtr = s_Data.CircleUploadBase;
+            break;
+        }
+        case DrawPacketType::Text: {
+            uint32_t remaining = (uint32_t)(s_Data.TextVertexBufferPtr - s_Data.TextVertexBufferBase) -
+                s_Data.TextVerticesEmitted;
+            s_Data.TextUploadBase = (TextVertex*)s_Data.TextVertexBuffer->map(remaining * sizeof(TextVertex));
+            s_Data.TextUploadPtr = s_Data.TextUploadBase;
+            break;
+        }
+        }
+    }
 
-            auto buf = s_Data.TextVertexBufferBase;
-            s_Data.FontAtlasTexture->bind(0);
+    // Draws a queued mesh range on its own, the batch state is left untouched
+    static void DrawFrameMesh(const FrameMesh& mesh, uint16_t frameTexture) {
+        SetModelMatrix(mesh.Model);
+        s_Data.WhiteTexture->bind(0);
+        s_Data.FrameTextures[frameTexture]->bind(1);
+
+        const Ref<Shader>& shader = mesh.Shader < 0 ? s_Data.QuadShader : s_Data.FrameShaders[mesh.Shader];
+        shader->bind();
+
+        // Generic attribute value, only read by meshes whose vertex array leaves a_EntityID disabled
+        if constexpr (VertexPolicy::HasEntityID)
+            glVertexAttribI1i(QuadEntityIDLocation, mesh.EntityID);
+
+        Renderer2D::CmdDrawIndexed(mesh.Mesh, mesh.IndexCount, mesh.FirstVertex);
+        s_Data.Stats.DrawCalls++;
+    }
+
+    void Renderer2D::EmitPacket(const DrawPacket& packet) {
+        if (packet.Type == DrawPacketType::Mesh) {
+            FlushBatch();
+            DrawFrameMesh(s_Data.FrameMeshes[packet.FirstVertex], packet.Texture);
+            return;
+        }
+
+        // A batch holds a single primitive type, text a single font atlas and custom quads a single shader
+        if (s_Data.BatchIndexCount && (packet.Type != s_Data.BatchType ||
+            (packet.Type == DrawPacketType::Text && packet.Texture != s_Data.BatchFontAtlas) ||
+            (packet.Type == DrawPacketType::ShaderQuad && packet.Shader != s_Data.BatchShader)))
+            FlushBatch();
+
+        s_Data.BatchType = packet.Type;
+        s_Data.BatchShader = packet.Shader;
+
+        float textureIndex = 0.0f;
+        if (packet.Type == DrawPacketType::Text) {
+            s_Data.BatchFontAtlas = packet.Texture;
+        }
+        else {
+            int32_t slot = s_Data.FrameTextureSlots[packet.Texture];
+            if (slot < 0) {
+                if (s_Data.TextureSlotIndex >= Renderer2DData::MaxTextureSlots)
+                    FlushBatch();
+
+                slot = (int32_t)s_Data.TextureSlotIndex++;
+                s_Data.TextureSlots[slot] = packet.Texture;
+                s_Data.FrameTextureSlots[packet.Texture] = slot;
+            }
+            textureIndex = (float)slot;
+        }
+
+        if (s_Data.BatchIndexCount == 0)
+            MapBatch(packet.Type);
+
+        // The upload pointers are write-combined GPU memory: patch a local copy and store each vertex once
+        switch (packet.Type) {
+        case DrawPacketType::Quad:
+        case DrawPacketType::ShaderQuad:
+            for (uint32_t i = 0; i < 4; i++) {
+                QuadVertex vertex = s_Data.QuadVertexBufferBase[packet.FirstVertex + i];
+                vertex.TexIndex = textureIndex;
+                *s_Data.QuadUploadPtr++ = vertex;
+            }
+            break;
+        case DrawPacketType::QuadInstance: {
+            QuadInstance instance = s_Data.QuadInstanceBufferBase[packet.FirstVertex];
+            instance.TexIndex = (int)textureIndex;
+            *s_Data.QuadInstanceUploadPtr++ = instance;
+            break;
+        }
+        case DrawPacketType::Circle:
+            for (uint32_t i = 0; i < 4; i++) {
+                CircleVertex vertex = s_Data.CircleVertexBufferBase[packet.FirstVertex + i];
+                vertex.TexIndex = textureIndex;
+                *s_Data.CircleUploadPtr++ = vertex;
+            }
+            break;
+        case DrawPacketType::Text:
+            for (uint32_t i = 0; i < 4; i++)
+                *s_Data.TextUploadPtr++ = s_Data.TextVertexBufferBase[packet.FirstVertex + i];
+            break;
+        }
+
+        s_Data.BatchIndexCount += 6;
+    }
+
+    void Renderer2D::FlushBatch() {
+        if (s_Data.BatchIndexCount == 0)
+            return;
+
+        SHADO_PROFILE_FUNCTION();
+
+        SetModelMatrix(glm::mat4(1.0f));
+        switch (s_Data.BatchType) {
+        case DrawPacketType::Quad:
+        case DrawPacketType::ShaderQuad: {
+            uint32_t vertexCount = (uint32_t)(s_Data.QuadUploadPtr - s_Data.QuadUploadBase);
+            uint32_t dataSize = vertexCount * sizeof(QuadVertex);
+            uint32_t baseVertex = s_Data.QuadVertexBuffer->commit(dataSize) / sizeof(QuadVertex);
+            s_Data.QuadVerticesEmitted += vertexCount;
+            s_Data.Stats.UploadedBytes += dataSize;
+
+            // Bind textures
+            for (uint32_t i = 0; i < s_Data.TextureSlotIndex; i++)
+                s_Data.FrameTextures[s_Data.TextureSlots[i]]->bind(i);
+
+            // Custom shaders use the quad vertex layout, so they share its vertex array
+            const Ref<Shader>& shader = s_Data.BatchType == DrawPacketType::ShaderQuad
+                                            ? s_Data.FrameShaders[s_Data.BatchShader]
+                                            : s_Data.QuadShader;
+            shader->bind();
+            CmdDrawIndexed(s_Data.QuadVertexArray, s_Data.BatchIndexCount, baseVertex);
+            break;
+        }
+        case DrawPacketType::QuadInstance: {
+            uint32_t instanceCount = (uint32_t)(s_Data.QuadInstanceUploadPtr - s_Data.QuadInstanceUploadBase);
+            uint32_t dataSize = instanceCount * sizeof(QuadInstance);
+            uint32_t baseInstance = s_Data.QuadInstanceBuffer->commit(dataSize) / sizeof(QuadInstance);
+            s_Data.QuadInstancesEmitted += instanceCount;
+            s_Data.Stats.UploadedBytes += dataSize;
+
+            for (uint32_t i = 0; i < s_Data.TextureSlotIndex; i++)
+                s_Data.FrameTextures[s_Data.TextureSlots[i]]->bind(i);
+
+            s_Data.QuadInstanceShader->bind();
+            CmdDrawIndexedInstanced(s_Data.QuadInstanceVertexArray, 6, instanceCount, baseInstance);
+            break;
+        }
+        case DrawPacketType::Circle: {
+            uint32_t vertexCount = (uint32_t)(s_Data.CircleUploadPtr - s_Data.CircleUploadBase);
+            uint32_t dataSize = vertexCount * sizeof(CircleVertex);
+            uint32_t baseVertex = s_Data.CircleVertexBuffer->commit(dataSize) / sizeof(CircleVertex);
+            s_Data.CircleVerticesEmitted += vertexCount;
+            s_Data.Stats.UploadedBytes += dataSize;
+
+            for (uint32_t i = 0; i < s_Data.TextureSlotIndex; i++)
+                s_Data.FrameTextures[s_Data.TextureSlots[i]]->bind(i);
+
+            s_Data.CircleShader->bind();
+            CmdDrawIndexed(s_Data.CircleVertexArray, s_Data.BatchIndexCount, baseVertex);
+            break;
+        }
+        case DrawPacketType::Text: {
+            uint32_t vertexCount = (uint32_t)(s_Data.TextUploadPtr - s_Data.TextUploadBase);
+            uint32_t dataSize = vertexCount * sizeof(TextVertex);
+            uint32_t baseVertex = s_Data.TextVertexBuffer->commit(dataSize) / sizeof(TextVertex);
+            s_Data.TextVerticesEmitted += vertexCount;
+            s_Data.Stats.UploadedBytes += dataSize;
+
+            s_Data.FrameTextures[s_Data.BatchFontAtlas]->bind(0);
 
             s_Data.TextShader->bind();
-            CmdDrawIndexed(s_Data.TextVertexArray, s_Data.TextIndexCount);
-            s_Data.Stats.DrawCalls++;
+            CmdDrawIndexed(s_Data.TextVertexArray, s_Data.BatchIndexCount, baseVertex);
 
             // Rebind white texture
             s_Data.WhiteTexture->bind(0);
+            break;
+        }
         }
+        s_Data.Stats.DrawCalls++;
+
+        // Release the texture slots of this batch, the white texture stays in slot 0
+        for (uint32_t i = 1; i < s_Data.TextureSlotIndex; i++)
+            s_Data.FrameTextureSlots[s_Data.TextureSlots[i]] = -1;
+        s_Data.TextureSlotIndex = 1;
+        s_Data.BatchIndexCount = 0;
+    }
+
+    void Renderer2D::SetLayer(uint32_t layer) {
+        SHADO_CORE_ASSERT(layer < 16, "Renderer2D supports 16 layers");
+        s_Data.Layer = layer;
     }
 
     void Renderer2D::SetClearColor(const glm::vec4& color) {
@@ -404,7 +1270,7 @@ namespace Shado {
     }
 
     void Renderer2D::NextBatch() {
-        Flush();
+        FlushPackets();
         StartBatch();
     }
 
@@ -439,194 +1305,232 @@ namespace Shado {
     void Renderer2D::DrawQuad(const glm::mat4& transform, const glm::vec4& color, int entityID) {
         SHADO_PROFILE_FUNCTION();
 
-        constexpr size_t quadVertexCount = 4;
-        constexpr float textureIndex = 0.0f; // White Texture
-        constexpr glm::vec2 textureCoords[] = {{0.0f, 0.0f}, {1.0f, 0.0f}, {1.0f, 1.0f}, {0.0f, 1.0f}};
         constexpr float tilingFactor = 1.0f;
 
+        const bool translucent = CPUAlphaZSorting && color.a < 1.0f;
+        if (DrawQuadInstance(transform, color, 0, tilingFactor, entityID, translucent))
+            return;
+
         if (s_Data.QuadIndexCount >= Renderer2DData::MaxIndices)
             NextBatch();
 
-        QuadVertex temp[quadVertexCount];
-        for (size_t i = 0; i < quadVertexCount; i++) {
-            temp[i].Position = transform * s_Data.QuadVertexPositions[i];
-            temp[i].Color = color;
-            temp[i].TexCoord = textureCoords[i];
-            temp[i].TexIndex = textureIndex;
-            temp[i].TilingFactor = tilingFactor;
-            temp[i].EntityID = entityID;
-        }
-
-        // If entity is transparent, Draw it later
-        QuadFace face;
-        for (size_t i = 0; i < quadVertexCount; i++) {
-            if (CPUAlphaZSorting && color.a < 1.0f) {
-                face.vertices.push_back(temp[i]);
-            }
-            else {
-                *s_Data.QuadVertexBufferPtr = temp[i];
-                s_Data.QuadVertexBufferPtr++;
-            }
-        }
-
-        // Again check if there's an alpha
-        // if yes, don't add the quad now, wait until the Flush so the alpha quads are drawn on top of everything
-        if (CPUAlphaZSorting && color.a < 1.0f) {
-            face.zBuffer = transform[3].z;
-            s_Data.transparentQuads.push_back(face);
-        }
-
-        s_Data.QuadIndexCount += 6;
-        s_Data.Stats.QuadCount++;
+        QuadVertex* vertices = PushQuadPacket(QuadPipeline, 0, transform[3].z, translucent);
+        WriteQuadVertices(vertices, transform, color, tilingFactor, entityID);
     }
 
     void Renderer2D::DrawQuad(const glm::mat4& transform, AssetHandle textureHandle, float tilingFactor,
                               const glm::vec4& tintColor, int entityID) {
         SHADO_PROFILE_FUNCTION();
 
-        constexpr size_t quadVertexCount = 4;
-        constexpr glm::vec2 textureCoords[] = {{0.0f, 0.0f}, {1.0f, 0.0f}, {1.0f, 1.0f}, {0.0f, 1.0f}};
-        Ref<Texture2D> texture = AssetManager::GetAsset<Texture2D>(textureHandle);
-
-        if (s_Data.QuadIndexCount >= Renderer2DData::MaxIndices)
+        if (s_Data.QuadIndexCount >= Renderer2DData::MaxIndices || FrameTexturesFull())
             NextBatch();
 
-        float textureIndex = 0.0f;
-        for (uint32_t i = 1; i < s_Data.TextureSlotIndex; i++) {
-            if (*s_Data.TextureSlots[i] == *texture) {
-                textureIndex = (float)i;
-                break;
-            }
-        }
+        // Atlas regions cannot repeat, tiled quads keep the standalone texture
+        glm::vec4 uvRect = FullUVRect;
+        const uint16_t frameTexture = GetFrameTextureIndex(textureHandle, tilingFactor == 1.0f ? &uvRect : nullptr);
+        DrawTexturedQuad(transform, frameTexture, tilingFactor, tintColor, entityID, uvRect);
+    }
 
-        if (textureIndex == 0.0f) {
-            if (s_Data.TextureSlotIndex >= Renderer2DData::MaxTextureSlots)
-                NextBatch();
+    void Renderer2D::DrawQuad(const glm::mat4& transform, const Ref<Texture2D>& texture, float tilingFactor,
+                              const glm::vec4& tintColor, int entityID) {
+        SHADO_PROFILE_FUNCTION();
 
-            textureIndex = (float)s_Data.TextureSlotIndex;
-            s_Data.TextureSlots[s_Data.TextureSlotIndex] = texture;
-            s_Data.TextureSlotIndex++;
-        }
+        if (s_Data.QuadIndexCount >= Renderer2DData::MaxIndices || FrameTexturesFull())
+            NextBatch();
 
-        QuadVertex temp[quadVertexCount];
-        for (size_t i = 0; i < quadVertexCount; i++) {
-            temp[i].Position = transform * s_Data.QuadVertexPositions[i];
-            temp[i].Color = tintColor;
-            temp[i].TexCoord = textureCoords[i];
-            temp[i].TexIndex = textureIndex;
-            temp[i].TilingFactor = tilingFactor;
-            temp[i].EntityID = entityID;
-        }
+        DrawTexturedQuad(transform, GetFrameTextureIndex(texture), tilingFactor, tintColor, entityID);
+    }
 
-        // If entity is transparent, Draw it later
-        QuadFace face;
-        for (size_t i = 0; i < quadVertexCount; i++) {
-            if (CPUAlphaZSorting && tintColor.a < 1.0f) {
-                face.vertices.push_back(temp[i]);
-            }
-            else {
-                *s_Data.QuadVertexBufferPtr = temp[i];
-                s_Data.QuadVertexBufferPtr++;
-            }
-        }
+    void Renderer2D::DrawTexturedQuad(const glm::mat4& transform, uint16_t frameTexture, float tilingFactor,
+                                      const glm::vec4& tintColor, int entityID, const glm::vec4& uvRect) {
+        // Textures may have transparent texels, so they are depth sorted with the translucent geometry
+        if (DrawQuadInstance(transform, tintColor, frameTexture, tilingFactor, entityID, CPUAlphaZSorting, uvRect))
+            return;
 
-        // Again check if there's an alpha
-        // if yes, don't add the quad now, wait until the Flush so the alpha quads are drawn on top of everything
-        if (CPUAlphaZSorting && tintColor.a < 1.0f) {
-            face.zBuffer = transform[3].z;
-            s_Data.transparentQuads.push_back(face);
+        QuadVertex* vertices = PushQuadPacket(QuadPipeline, frameTexture, transform[3].z, CPUAlphaZSorting);
+        WriteQuadVertices(vertices, transform, tintColor, tilingFactor, entityID, uvRect);
+    }
+
+    bool Renderer2D::DrawQuadInstance(const glm::mat4& transform, const glm::vec4& color, uint16_t frameTexture,
+                                      float tilingFactor, int entityID, bool translucent, const glm::vec4& uvRect) {
+        if (!UseQuadInstance(transform))
+            return false;
+
+        if (s_Data.QuadInstanceCount >= Renderer2DData::MaxQuads) {
+            Ref<Texture2D> texture = s_Data.FrameTextures[frameTexture];
+            NextBatch();
+            frameTexture = GetFrameTextureIndex(texture);
         }
 
-        s_Data.QuadIndexCount += 6;
-        s_Data.Stats.QuadCount++;
+        QuadInstance& instance = PushQuadInstancePacket(frameTexture, transform[3].z, translucent);
+        WriteQuadInstance(instance, transform, color, tilingFactor, entityID, uvRect);
+        return true;
     }
 
     void Renderer2D::DrawQuad(const glm::mat4& transform, AssetHandle shaderHandle, const glm::vec4& color,
-                              int entityID,
-                              float textureIndex) {
+                              int entityID) {
         SHADO_PROFILE_FUNCTION();
-        Ref<Shader> shader = AssetManager::GetAsset<Shader>(shaderHandle);
-        shader->bind();
 
-        uint32_t quadIndices[6];
-        quadIndices[0] = 0;
-        quadIndices[1] = 1;
-        quadIndices[2] = 2;
-        quadIndices[3] = 2;
-        quadIndices[4] = 3;
-        quadIndices[5] = 0;
-
-        Ref<VertexArray> vertexArray = CreateRef<VertexArray>();
-        Ref<VertexBuffer> buffer = VertexBuffer::create(4 * sizeof(QuadVertex));
-        buffer->setLayout({
-            {ShaderDataType::Float3, "a_Position"},
-            {ShaderDataType::Float4, "a_Color"},
-            {ShaderDataType::Float2, "a_TexCoord"},
-            {ShaderDataType::Float, "a_TexIndex"},
-            {ShaderDataType::Float, "a_TilingFactor"},
-            {ShaderDataType::Int, "a_EntityID"}
-        });
-        vertexArray->addVertexBuffer(buffer);
-        Ref<IndexBuffer> indexBuffer = CreateRef<IndexBuffer>(quadIndices, 6);
-        vertexArray->setIndexBuffer(indexBuffer);
-
-        constexpr size_t quadVertexCount = 4;
-        constexpr glm::vec2 textureCoords[] = {{0.0f, 0.0f}, {1.0f, 0.0f}, {1.0f, 1.0f}, {0.0f, 1.0f}};
+        DrawShaderQuad(transform, shaderHandle, 0, color, entityID, CPUAlphaZSorting && color.a < 1.0f);
+    }
 
-        QuadVertex vertex[4];
-        for (size_t i = 0; i < quadVertexCount; i++) {
-            vertex[i].Position = transform * s_Data.QuadVertexPositions[i];
-            vertex[i].Color = color;
-            vertex[i].TexCoord = textureCoords[i];
-            vertex[i].TexIndex = textureIndex;
-            vertex[i].TilingFactor = 1.0f;
-            vertex[i].EntityID = entityID;
-        }
+    void Renderer2D::DrawQuad(const glm::mat4& transform, AssetHandle textureHandle, AssetHandle shaderHandle,
+                              const glm::vec4& color, int entityID) {
+        SHADO_PROFILE_FUNCTION();
+
+        if (FrameTexturesFull())
+            NextBatch();
 
-        buffer->setData(&vertex, 4 * sizeof(QuadVertex));
+        DrawShaderQuad(transform, shaderHandle, GetFrameTextureIndex(textureHandle), color, entityID,
+                       CPUAlphaZSorting);
+    }
 
-        // if transparent, then draw 
-        if (color.a < 1.0f) {
+    void Renderer2D::DrawShaderQuad(const glm::mat4& transform, AssetHandle shaderHandle, uint16_t frameTexture,
+                                    const glm::vec4& color, int entityID, bool translucent, const glm::vec4& uvRect) {
+        if (s_Data.QuadIndexCount >= Renderer2DData::MaxIndices ||
+            s_Data.FrameShaderCount >= Renderer2DData::MaxFrameShaders) {
+            Ref<Texture2D> texture = s_Data.FrameTextures[frameTexture];
             NextBatch();
+            frameTexture = GetFrameTextureIndex(texture);
         }
 
-        shader->bind();
-        shader->setFloat("u_Time", (float)glfwGetTime());
+        // Sprites sharing a shader sort next to each other and end up in the same batch.
+        // A handle that does not resolve to a shader falls back to the default quad shader
+        const int32_t shader = GetFrameShaderIndex(shaderHandle);
+        QuadVertex* vertices = PushQuadPacket(shader < 0 ? QuadPipeline : ShaderQuadPipeline + shader, frameTexture,
+                                              transform[3].z, translucent,
+                                              shader < 0 ? DrawPacketType::Quad : DrawPacketType::ShaderQuad,
+                                              (uint8_t)std::max(shader, 0));
+        WriteQuadVertices(vertices, transform, color, 1.0f, entityID, uvRect);
+    }
 
-        auto res = glm::vec2{Application::get().getWindow().getWidth(), Application::get().getWindow().getHeight()};
-        shader->setFloat2("u_ScreenResolution", res);
-        shader->setFloat2("u_MousePos", {Input::getMouseX(), Input::getMouseY()});
+    uint32_t Renderer2D::ReserveQuads(size_t count) {
+        auto room = [] {
+            uint32_t quads = (Renderer2DData::MaxIndices - s_Data.QuadIndexCount) / 6;
+            if (s_Data.Specification.InstancedQuads)
+                quads = std::min(quads, Renderer2DData::MaxQuads - s_Data.QuadInstanceCount);
+            return quads;
+        };
 
-        CmdDrawIndexed(vertexArray, indexBuffer->getCount());
-        s_Data.Stats.DrawCalls++;
-        s_Data.Stats.QuadCount++;
+        uint32_t available = room();
+        if (available == 0) {
+            NextBatch();
+            available = room();
+        }
+        return (uint32_t)std::min<size_t>(count, available);
     }
 
-    void Renderer2D::DrawQuad(const glm::mat4& transform, AssetHandle textureHandle, AssetHandle shaderHandle,
-                              const glm::vec4& color, int entityID) {
+    void Renderer2D::DrawQuads(std::span<const glm::mat4> transforms, std::span<const glm::vec4> colors,
+                               std::span<const int> entityIDs) {
         SHADO_PROFILE_FUNCTION();
-        Ref<Texture2D> texture = AssetManager::GetAsset<Texture2D>(textureHandle);
-        
-        float textureIndex = 0.0f;
-        for (uint32_t i = 1; i < s_Data.TextureSlotIndex; i++) {
-            if (*s_Data.TextureSlots[i] == *texture) {
-                textureIndex = (float)i;
-                break;
+        SHADO_CORE_ASSERT(colors.size() == transforms.size() || colors.size() == 1,
+                          "DrawQuads needs one color per quad, or a single one");
+        SHADO_CORE_ASSERT(entityIDs.empty() || entityIDs.size() == transforms.size(),
+                          "DrawQuads needs one entity ID per quad");
+
+        const size_t colorStride = colors.size() == 1 ? 0 : 1;
+        for (size_t first = 0; first < transforms.size();) {
+            const size_t last = first + ReserveQuads(transforms.size() - first);
+            for (size_t i = first; i < last; i++) {
+                const glm::vec4& color = colors[i * colorStride];
+                PushQuad(transforms[i], color, 0, 1.0f, entityIDs.empty() ? -1 : entityIDs[i],
+                         CPUAlphaZSorting && color.a < 1.0f, FullUVRect);
             }
+            first = last;
         }
+    }
 
-        if (textureIndex == 0.0f) {
-            if (s_Data.TextureSlotIndex >= Renderer2DData::MaxTextureSlots)
+    void Renderer2D::DrawQuads(std::span<const glm::mat4> transforms, AssetHandle textureHandle,
+                               std::span<const glm::vec4> tintColors, float tilingFactor,
+                               std::span<const int> entityIDs) {
+        SHADO_PROFILE_FUNCTION();
+        SHADO_CORE_ASSERT(tintColors.size() == transforms.size() || tintColors.size() == 1,
+                          "DrawQuads needs one color per quad, or a single one");
+        SHADO_CORE_ASSERT(entityIDs.empty() || entityIDs.size() == transforms.size(),
+                          "DrawQuads needs one entity ID per quad");
+
+        const size_t colorStride = tintColors.size() == 1 ? 0 : 1;
+        for (size_t first = 0; first < transforms.size();) {
+            if (FrameTexturesFull())
                 NextBatch();
-
-            textureIndex = (float)s_Data.TextureSlotIndex;
-            s_Data.TextureSlots[s_Data.TextureSlotIndex] = texture;
-            s_Data.TextureSlotIndex++;
+            const size_t last = first + ReserveQuads(transforms.size() - first);
+
+            // Resolved once per batch, starting a batch clears the frame texture table
+            glm::vec4 uvRect = FullUVRect;
+            const uint16_t frameTexture = GetFrameTextureIndex(textureHandle,
+                                                               tilingFactor == 1.0f ? &uvRect : nullptr);
+            for (size_t i = first; i < last; i++) {
+                PushQuad(transforms[i], tintColors[i * colorStride], frameTexture, tilingFactor,
+                         entityIDs.empty() ? -1 : entityIDs[i], CPUAlphaZSorting, uvRect);
+            }
+            first = last;
         }
+    }
+
+    void Renderer2D::DrawQuads(const QuadBatch& quads) {
+        SHADO_PROFILE_FUNCTION();
 
-        texture->bind(textureIndex);
-        DrawQuad(transform, shaderHandle, color, entityID, textureIndex);
-        texture->unbind();
+        const size_t count = quads.PositionX.size();
+        SHADO_CORE_ASSERT(quads.PositionY.size() == count && quads.SizeX.size() == count &&
+                          quads.SizeY.size() == count, "QuadBatch positions and sizes must have the same length");
+        SHADO_CORE_ASSERT(quads.PositionZ.empty() || quads.PositionZ.size() == count,
+                          "QuadBatch depths must match the positions");
+        SHADO_CORE_ASSERT(quads.Rotation.empty() || quads.Rotation.size() == count,
+                          "QuadBatch rotations must match the positions");
+        SHADO_CORE_ASSERT(quads.Colors.size() <= 1 || quads.Colors.size() == count,
+                          "QuadBatch needs one color per quad, or a single one");
+        SHADO_CORE_ASSERT(quads.EntityIDs.empty() || quads.EntityIDs.size() == count,
+                          "QuadBatch needs one entity ID per quad");
+
+        static constexpr glm::vec4 white = {1.0f, 1.0f, 1.0f, 1.0f};
+        const std::span<const glm::vec4> colors = quads.Colors.empty()
+                                                      ? std::span<const glm::vec4>(&white, 1)
+                                                      : quads.Colors;
+        const size_t colorStride = colors.size() == 1 ? 0 : 1;
+        const bool textured = quads.Texture != 0;
+
+        // Every QuadBatch quad is flat, so it always fits the instance record when instancing is on
+        const bool instanced = s_Data.Specification.InstancedQuads;
+
+        QuadBatchLanes lanes;
+        for (size_t first = 0; first < count;) {
+            if (textured && FrameTexturesFull())
+                NextBatch();
+            const size_t last = first + ReserveQuads(count - first);
+
+            glm::vec4 uvRect = FullUVRect;
+            const uint16_t frameTexture = textured ? GetFrameTextureIndex(quads.Texture, &uvRect) : (uint16_t)0;
+
+            for (size_t i = first; i < last; i += 4) {
+                const size_t laneCount = std::min<size_t>(4, last - i);
+                ComputeQuadBatchLanes(quads, i, laneCount, lanes);
+
+                for (size_t lane = 0; lane < laneCount; lane++) {
+                    const size_t index = i + lane;
+                    const glm::vec4& color = colors[index * colorStride];
+                    const float depth = quads.PositionZ.empty() ? 0.0f : quads.PositionZ[index];
+                    const int entityID = quads.EntityIDs.empty() ? -1 : quads.EntityIDs[index];
+                    const bool translucent = CPUAlphaZSorting && (textured || color.a < 1.0f);
+
+                    if (instanced) {
+                        QuadInstance& instance = PushQuadInstancePacket(frameTexture, depth, translucent);
+                        instance.Transform = {lanes.AxisX[lane], lanes.AxisY[lane], lanes.UpX[lane], lanes.UpY[lane]};
+                        instance.Translation = {quads.PositionX[index], quads.PositionY[index], depth};
+                        instance.Color = glm::packUnorm4x8(color);
+                        instance.TexRect = uvRect;
+                        instance.TexIndex = 0;
+                        instance.setEntityID(entityID);
+                        continue;
+                    }
+
+                    QuadVertex* vertices = PushQuadPacket(QuadPipeline, frameTexture, depth, translucent);
+                    for (size_t corner = 0; corner < 4; corner++)
+                        vertices[corner].Position = {lanes.CornerX[corner][lane], lanes.CornerY[corner][lane], depth};
+                    WriteQuadAttributes(vertices, color, 1.0f, entityID, uvRect);
+                }
+            }
+            first = last;
+        }
     }
 
     void Renderer2D::DrawRotatedQuad(const glm::vec2& position, const glm::vec2& size, const glm::vec3& rotation,
@@ -666,18 +1570,24 @@ namespace Shado {
     void Renderer2D::DrawCircle(const glm::mat4& transform, const glm::vec4& color, float thickness /*= 1.0f*/,
                                 float fade /*= 0.005f*/, int entityID /*= -1*/) {
         SHADO_PROFILE_FUNCTION();
-        // TODO: implement for circles
-        // if (s_Data.QuadIndexCount >= Renderer2DData::MaxIndices)
-        // 	NextBatch();
         constexpr glm::vec2 textureCoords[] = {{0.0f, 0.0f}, {1.0f, 0.0f}, {1.0f, 1.0f}, {0.0f, 1.0f}};
 
+        if (s_Data.CircleIndexCount >= Renderer2DData::MaxIndices)
+            NextBatch();
+
+        // Circles have soft edges (fade), so they always blend
+        s_Data.Packets[s_Data.PacketCount++] = {
+            MakeSortKey(CirclePipeline, 0, transform[3].z, CPUAlphaZSorting),
+            (uint32_t)(s_Data.CircleVertexBufferPtr - s_Data.CircleVertexBufferBase), 0, DrawPacketType::Circle
+        };
+
         for (size_t i = 0; i < 4; i++) {
             s_Data.CircleVertexBufferPtr->WorldPosition = transform * s_Data.QuadVertexPositions[i];
-            s_Data.CircleVertexBufferPtr->LocalPosition = s_Data.QuadVertexPositions[i] * 2.0f;
+            s_Data.CircleVertexBufferPtr->LocalPosition = glm::vec2(s_Data.QuadVertexPositions[i]) * 2.0f;
             s_Data.CircleVertexBufferPtr->Color = color;
             s_Data.CircleVertexBufferPtr->Thickness = thickness;
             s_Data.CircleVertexBufferPtr->Fade = fade;
-            s_Data.CircleVertexBufferPtr->EntityID = entityID;
+            s_Data.CircleVertexBufferPtr->setEntityID(entityID);
             s_Data.CircleVertexBufferPtr->TexIndex = 0.0f;
             s_Data.CircleVertexBufferPtr->TilingFactor = 1.0f;
             s_Data.CircleVertexBufferPtr->TexCoord = textureCoords[i];
@@ -694,35 +1604,26 @@ namespace Shado {
         SHADO_PROFILE_FUNCTION();
 
         constexpr glm::vec2 textureCoords[] = {{0.0f, 0.0f}, {1.0f, 0.0f}, {1.0f, 1.0f}, {0.0f, 1.0f}};
-        Ref<Texture2D> texture = AssetManager::GetAsset<Texture2D>(textureHandle);
-
-        float textureIndex = 0.0f;
-        for (uint32_t i = 1; i < s_Data.TextureSlotIndex; i++) {
-            if (*s_Data.TextureSlots[i] == *texture) {
-                textureIndex = (float)i;
-                break;
-            }
-        }
 
-        if (textureIndex == 0.0f) {
-            if (s_Data.TextureSlotIndex >= Renderer2DData::MaxTextureSlots)
-                NextBatch();
+        if (s_Data.CircleIndexCount >= Renderer2DData::MaxIndices || FrameTexturesFull())
+            NextBatch();
 
-            textureIndex = (float)s_Data.TextureSlotIndex;
-            s_Data.TextureSlots[s_Data.TextureSlotIndex] = texture;
-            s_Data.TextureSlotIndex++;
-        }
+        const uint16_t frameTexture = GetFrameTextureIndex(textureHandle);
+        s_Data.Packets[s_Data.PacketCount++] = {
+            MakeSortKey(CirclePipeline, frameTexture, transform[3].z, CPUAlphaZSorting),
+            (uint32_t)(s_Data.CircleVertexBufferPtr - s_Data.CircleVertexBufferBase), frameTexture,
+            DrawPacketType::Circle
+        };
 
         for (size_t i = 0; i < 4; i++) {
             s_Data.CircleVertexBufferPtr->WorldPosition = transform * s_Data.QuadVertexPositions[i];
-            s_Data.CircleVertexBufferPtr->LocalPosition = s_Data.QuadVertexPositions[i] * 2.0f;
+            s_Data.CircleVertexBufferPtr->LocalPosition = glm::vec2(s_Data.QuadVertexPositions[i]) * 2.0f;
             s_Data.CircleVertexBufferPtr->Color = tintColor;
             s_Data.CircleVertexBufferPtr->Thickness = thickness;
             s_Data.CircleVertexBufferPtr->Fade = fade;
-            s_Data.CircleVertexBufferPtr->EntityID = entityID;
+            s_Data.CircleVertexBufferPtr->setEntityID(entityID);
 
             s_Data.CircleVertexBufferPtr->TexCoord = textureCoords[i];
-            s_Data.CircleVertexBufferPtr->TexIndex = textureIndex;
             s_Data.CircleVertexBufferPtr->TilingFactor = tilingFactor;
             s_Data.CircleVertexBufferPtr++;
         }
@@ -735,14 +1636,19 @@ namespace Shado {
     void Renderer2D::DrawLine(const glm::vec3& p0, const glm::vec3& p1, const glm::vec4& color, int entityID) {
         SHADO_PROFILE_FUNCTION();
 
+        if (s_Data.LineVertexCount >= Renderer2DData::MaxVertices)
+            FlushLines();
+        if (s_Data.LineVertexBufferPtr == nullptr)
+            StartLineBatch();
+
         s_Data.LineVertexBufferPtr->Position = p0;
         s_Data.LineVertexBufferPtr->Color = color;
-        s_Data.LineVertexBufferPtr->EntityID = entityID;
+        s_Data.LineVertexBufferPtr->setEntityID(entityID);
         s_Data.LineVertexBufferPtr++;
 
         s_Data.LineVertexBufferPtr->Position = p1;
         s_Data.LineVertexBufferPtr->Color = color;
-        s_Data.LineVertexBufferPtr->EntityID = entityID;
+        s_Data.LineVertexBufferPtr->setEntityID(entityID);
         s_Data.LineVertexBufferPtr++;
 
         s_Data.LineVertexCount += 2;
@@ -776,19 +1682,618 @@ namespace Shado {
     }
 
     void Renderer2D::DrawSprite(const glm::mat4& transform, SpriteRendererComponent& src, int entityID) {
+        if (!src.texture) {
+            if (src.shader)
+                DrawQuad(transform, src.shader, src.color, entityID);
+            else
+                DrawQuad(transform, src.color, entityID);
+            return;
+        }
+
+        SHADO_PROFILE_FUNCTION();
+
+        if (s_Data.QuadIndexCount >= Renderer2DData::MaxIndices || FrameTexturesFull())
+            NextBatch();
+
+        // Custom shaders may rely on the UVs of the whole texture, so only plain untiled sprites use the atlas
+        glm::vec4 uvRect = src.uvRect;
         if (src.shader) {
-            if (src.texture) {
-                DrawQuad(transform, src.texture, src.shader, src.color, entityID);
+            DrawShaderQuad(transform, src.shader, GetFrameTextureIndex(src.texture), src.color, entityID,
+                           CPUAlphaZSorting, uvRect);
+            return;
+        }
+
+        const uint16_t frameTexture = GetFrameTextureIndex(src.texture,
+                                                           src.tilingFactor == 1.0f ? &uvRect : nullptr);
+        DrawTexturedQuad(transform, frameTexture, src.tilingFactor, src.color, entityID, uvRect);
+    }
+
+    struct RecordedPacket {
+        float Depth;
+        uint32_t First; // Into Vertices, or Instances for QuadInstance
+        uint16_t Texture; // Into TextureHandles, 0 = white texture
+        uint16_t Shader; // Into ShaderHandles, ShaderQuad only
+        DrawPacketType Type;
+        bool Translucent;
+        bool Atlased; // Untiled plain sprite, its UVs are remapped if the texture was packed
+    };
+
+    struct Renderer2DRecorder::Storage {
+        std::vector<RecordedPacket> Packets;
+        std::vector<QuadVertex> Vertices;
+        std::vector<QuadInstance> Instances;
+
+        // Workers only see asset handles, Submit resolves each distinct one on the main thread
+        std::vector<AssetHandle> TextureHandles;
+        std::vector<AssetHandle> ShaderHandles;
+        std::unordered_map<AssetHandle, uint16_t> TextureLookup;
+        std::unordered_map<AssetHandle, uint16_t> ShaderLookup;
+
+        // Submit scratch. A frame index is valid while its stamp matches Renderer2DData::QueueStamp
+        std::vector<uint16_t> FrameTextures;
+        std::vector<glm::vec4> FrameTextureRects; // Atlas rect of the texture, full rect if it is not packed
+        std::vector<uint32_t> FrameTextureStamps;
+        std::vector<uint16_t> StandaloneTextures; // For the packets that cannot use the atlas
+        std::vector<uint32_t> StandaloneTextureStamps;
+        std::vector<int32_t> FrameShaders;
+        std::vector<uint32_t> FrameShaderStamps;
+
+        uint32_t VisibleCount = 0;
+        uint32_t CulledCount = 0;
+
+        static uint16_t GetLocalIndex(std::vector<AssetHandle>& handles,
+                                      std::unordered_map<AssetHandle, uint16_t>& lookup, AssetHandle handle) {
+            auto [it, inserted] = lookup.try_emplace(handle, (uint16_t)handles.size());
+            if (inserted) {
+                SHADO_CORE_ASSERT(handles.size() < UINT16_MAX, "Too many assets in a Renderer2DRecorder");
+                handles.push_back(handle);
             }
-            else
-                DrawQuad(transform, src.shader, src.color, entityID);
+            return it->second;
+        }
+    };
+
+    Renderer2DRecorder::Renderer2DRecorder()
+        : m_Storage(CreateScoped<Storage>()) {
+        reset();
+    }
+
+    Renderer2DRecorder::~Renderer2DRecorder() = default;
+
+    void Renderer2DRecorder::reset() {
+        m_Storage->Packets.clear();
+        m_Storage->Vertices.clear();
+        m_Storage->Instances.clear();
+        m_Storage->TextureLookup.clear();
+        m_Storage->ShaderLookup.clear();
+        m_Storage->TextureHandles.assign(1, 0); // White texture
+        m_Storage->ShaderHandles.clear();
+        m_Storage->VisibleCount = 0;
+        m_Storage->CulledCount = 0;
+    }
+
+    bool Renderer2DRecorder::isVisible(const glm::vec4& bounds) {
+        // The view rectangle is only written by the main thread between scenes, workers just read it
+        if (!s_Data.Culling || ViewCulling::Overlaps(bounds, s_Data.ViewRect)) {
+            m_Storage->VisibleCount++;
+            return true;
+        }
+
+        m_Storage->CulledCount++;
+        return false;
+    }
+
+    void Renderer2DRecorder::drawSprite(const glm::mat4& transform, const SpriteRendererComponent& sprite,
+                                        int entityID) {
+        Storage& storage = *m_Storage;
+        const bool textured = sprite.texture != 0;
+
+        // Same rules as the immediate DrawQuad overloads DrawSprite picks
+        RecordedPacket packet;
+        packet.Depth = transform[3].z;
+        packet.Texture = textured ? Storage::GetLocalIndex(storage.TextureHandles, storage.TextureLookup,
+                                                           sprite.texture) : 0;
+        packet.Shader = 0;
+        packet.Translucent = Renderer2D::CPUAlphaZSorting && (textured || sprite.color.a < 1.0f);
+        packet.Atlased = textured && !sprite.shader && sprite.tilingFactor == 1.0f;
+
+        const float tilingFactor = textured && !sprite.shader ? sprite.tilingFactor : 1.0f;
+        if (sprite.shader) {
+            packet.Type = DrawPacketType::ShaderQuad;
+            packet.Shader = Storage::GetLocalIndex(storage.ShaderHandles, storage.ShaderLookup, sprite.shader);
+        }
+        else if (UseQuadInstance(transform)) {
+            packet.Type = DrawPacketType::QuadInstance;
+            packet.First = (uint32_t)storage.Instances.size();
+            WriteQuadInstance(storage.Instances.emplace_back(), transform, sprite.color, tilingFactor, entityID,
+                              sprite.uvRect);
+            storage.Packets.push_back(packet);
+            return;
         }
         else {
-            if (src.texture) {
-                DrawQuad(transform, src.texture, src.tilingFactor, src.color, entityID);
+            packet.Type = DrawPacketType::Quad;
+        }
+
+        packet.First = (uint32_t)storage.Vertices.size();
+        storage.Vertices.resize(storage.Vertices.size() + 4);
+        WriteQuadVertices(&storage.Vertices[packet.First], transform, sprite.color, tilingFactor, entityID,
+                          sprite.uvRect);
+        storage.Packets.push_back(packet);
+    }
+
+    Renderer2DRecorder& Renderer2D::GetRecorder(uint32_t index) {
+        while (s_Data.Recorders.size() <= index)
+            s_Data.Recorders.emplace_back();
+        return s_Data.Recorders[index];
+    }
+
+    static void RecordWorker(uint32_t index) {
+        uint64_t generation = 0;
+        while (true) {
+            const std::function<void(Renderer2DRecorder&, uint32_t)>* job = nullptr;
+            {
+                std::unique_lock<std::mutex> lock(s_Data.RecordMutex);
+                s_Data.RecordWake.wait(lock, [generation] {
+                    return !s_Data.RecordRunning || s_Data.RecordGeneration != generation;
+                });
+                if (!s_Data.RecordRunning)
+                    return;
+
+                generation = s_Data.RecordGeneration;
+                if (index >= s_Data.RecordCount)
+                    continue;
+                job = s_Data.RecordJob;
+            }
+
+            (*job)(s_Data.Recorders[index], index);
+
+            std::lock_guard<std::mutex> lock(s_Data.RecordMutex);
+            if (--s_Data.RecordPending == 0)
+                s_Data.RecordDone.notify_one();
+        }
+    }
+
+    void Renderer2D::RecordParallel(uint32_t recorderCount,
+                                    const std::function<void(Renderer2DRecorder& recorder, uint32_t index)>& job) {
+        SHADO_PROFILE_FUNCTION();
+
+        if (recorderCount == 0)
+            return;
+
+        // Every recorder exists before any worker looks at the deque
+        GetRecorder(recorderCount - 1);
+
+        if (recorderCount > 1) {
+            if (!s_Data.RecordRunning) {
+                s_Data.RecordRunning = true;
+                const uint32_t threadCount = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+                for (uint32_t i = 0; i < threadCount; i++)
+                    s_Data.RecordThreads.emplace_back(RecordWorker, i + 1);
+            }
+
+            SHADO_CORE_ASSERT(recorderCount <= s_Data.RecordThreads.size() + 1, "More recorders than workers");
+            {
+                std::lock_guard<std::mutex> lock(s_Data.RecordMutex);
+                s_Data.RecordJob = &job;
+                s_Data.RecordCount = recorderCount;
+                s_Data.RecordPending = recorderCount - 1;
+                s_Data.RecordGeneration++;
+            }
+            s_Data.RecordWake.notify_all();
+        }
+
+        job(s_Data.Recorders[0], 0);
+
+        std::unique_lock<std::mutex> lock(s_Data.RecordMutex);
+        s_Data.RecordDone.wait(lock, [] { return s_Data.RecordPending == 0; });
+        s_Data.RecordJob = nullptr;
+    }
+
+    void Renderer2D::Submit(Renderer2DRecorder& recorder) {
+        SHADO_PROFILE_FUNCTION();
+
+        auto& storage = *recorder.m_Storage;
+        s_Data.Stats.VisibleCount += storage.VisibleCount;
+        s_Data.Stats.CulledCount += storage.CulledCount;
+
+        storage.FrameTextures.resize(storage.TextureHandles.size());
+        storage.FrameTextureRects.resize(storage.TextureHandles.size());
+        storage.FrameTextureStamps.assign(storage.TextureHandles.size(), 0);
+        storage.StandaloneTextures.resize(storage.TextureHandles.size());
+        storage.StandaloneTextureStamps.assign(storage.TextureHandles.size(), 0);
+        storage.FrameShaders.resize(storage.ShaderHandles.size());
+        storage.FrameShaderStamps.assign(storage.ShaderHandles.size(), 0);
+
+        for (const RecordedPacket& recorded : storage.Packets) {
+            const bool instanced = recorded.Type == DrawPacketType::QuadInstance;
+            if ((instanced
+                     ? s_Data.QuadInstanceCount >= Renderer2DData::MaxQuads
+                     : s_Data.QuadIndexCount >= Renderer2DData::MaxIndices) ||
+                FrameTexturesFull() ||
+                s_Data.FrameShaderCount >= Renderer2DData::MaxFrameShaders)
+                NextBatch();
+
+            // NextBatch resets the frame tables, so resolved indices are re-checked against the queue stamp
+            uint16_t frameTexture = 0;
+            const glm::vec4* atlasRect = nullptr;
+            if (recorded.Texture && recorded.Atlased) {
+                if (storage.FrameTextureStamps[recorded.Texture] != s_Data.QueueStamp) {
+                    glm::vec4& rect = storage.FrameTextureRects[recorded.Texture];
+                    rect = FullUVRect;
+                    storage.FrameTextures[recorded.Texture] = GetFrameTextureIndex(
+                        storage.TextureHandles[recorded.Texture], &rect);
+                    storage.FrameTextureStamps[recorded.Texture] = s_Data.QueueStamp;
+                }
+                frameTexture = storage.FrameTextures[recorded.Texture];
+                if (storage.FrameTextureRects[recorded.Texture] != FullUVRect)
+                    atlasRect = &storage.FrameTextureRects[recorded.Texture];
+            }
+            else if (recorded.Texture) {
+                if (storage.StandaloneTextureStamps[recorded.Texture] != s_Data.QueueStamp) {
+                    storage.StandaloneTextures[recorded.Texture] = GetFrameTextureIndex(
+                        storage.TextureHandles[recorded.Texture]);
+                    storage.StandaloneTextureStamps[recorded.Texture] = s_Data.QueueStamp;
+                }
+                frameTexture = storage.StandaloneTextures[recorded.Texture];
+            }
+
+            DrawPacketType type = recorded.Type;
+            uint32_t pipeline = instanced ? QuadInstancePipeline : QuadPipeline;
+            int32_t shader = 0;
+            if (type == DrawPacketType::ShaderQuad) {
+                if (storage.FrameShaderStamps[recorded.Shader] != s_Data.QueueStamp) {
+                    storage.FrameShaders[recorded.Shader] = GetFrameShaderIndex(storage.ShaderHandles[recorded.Shader]);
+                    storage.FrameShaderStamps[recorded.Shader] = s_Data.QueueStamp;
+                }
+
+                shader = storage.FrameShaders[recorded.Shader];
+                if (shader < 0) {
+                    type = DrawPacketType::Quad;
+                    shader = 0;
+                }
+                else {
+                    pipeline = ShaderQuadPipeline + shader;
+                }
+            }
+
+            if (instanced) {
+                s_Data.Packets[s_Data.PacketCount++] = {
+                    MakeSortKey(pipeline, frameTexture, recorded.Depth, recorded.Translucent),
+                    s_Data.QuadInstanceCount, frameTexture, type, 0
+                };
+                QuadInstance& instance = *s_Data.QuadInstanceBufferPtr++;
+                instance = storage.Instances[recorded.First];
+                if (atlasRect)
+                    instance.TexRect = SpriteAtlas::ComposeUVRect(*atlasRect, instance.TexRect);
+                s_Data.QuadInstanceCount++;
+            }
+            else {
+                s_Data.Packets[s_Data.PacketCount++] = {
+                    MakeSortKey(pipeline, frameTexture, recorded.Depth, recorded.Translucent),
+                    (uint32_t)(s_Data.QuadVertexBufferPtr - s_Data.QuadVertexBufferBase), frameTexture, type,
+                    (uint8_t)shader
+                };
+                std::memcpy(s_Data.QuadVertexBufferPtr, &storage.Vertices[recorded.First], 4 * sizeof(QuadVertex));
+                if (atlasRect) {
+                    const glm::vec2 min = {atlasRect->x, atlasRect->y};
+                    const glm::vec2 size = glm::vec2(atlasRect->z, atlasRect->w) - min;
+                    for (uint32_t i = 0; i < 4; i++) {
+                        QuadVertex& vertex = s_Data.QuadVertexBufferPtr[i];
+                        vertex.TexCoord = min + glm::vec2(vertex.TexCoord) * size;
+                    }
+                }
+                s_Data.QuadVertexBufferPtr += 4;
+                s_Data.QuadIndexCount += 6;
+            }
+
+            s_Data.Stats.QuadCount++;
+        }
+    }
+
+    struct StaticSpriteBatch::Storage {
+        struct Sprite {
+            glm::mat4 Transform;
+            SpriteRendererComponent Component;
+            int EntityID;
+        };
+
+        // One mesh packet: a run of quads sharing a shader and a texture. Translucent groups also share a depth
+        // so they sort against the dynamic sprites like any of their quads would
+        struct Group {
+            uint32_t FirstVertex = 0;
+            uint32_t QuadCount = 0;
+            AssetHandle Shader = 0; // 0 for the default quad shader
+            Ref<Texture2D> Texture; // Null for the white texture
+            bool Translucent = false;
+            float Depth = -FLT_MAX; // Shared z when translucent, nearest z otherwise
+            glm::vec4 Bounds = {FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX};
+        };
+
+        std::vector<Sprite> Sprites;
+        std::vector<Group> Groups;
+        Ref<VertexArray> Mesh;
+    };
+
+    StaticSpriteBatch::StaticSpriteBatch()
+        : m_Storage(CreateScoped<Storage>()) {
+    }
+
+    StaticSpriteBatch::~StaticSpriteBatch() = default;
+
+    void StaticSpriteBatch::clear() {
+        m_Storage->Sprites.clear();
+    }
+
+    void StaticSpriteBatch::addSprite(const glm::mat4& transform, const SpriteRendererComponent& sprite,
+                                      int entityID) {
+        m_Storage->Sprites.push_back({transform, sprite, entityID});
+    }
+
+    uint32_t StaticSpriteBatch::getSpriteCount() const {
+        return (uint32_t)m_Storage->Sprites.size();
+    }
+
+    void StaticSpriteBatch::build() {
+        SHADO_PROFILE_FUNCTION();
+
+        Storage& storage = *m_Storage;
+        storage.Groups.clear();
+        storage.Mesh = nullptr;
+        if (storage.Sprites.empty())
+            return;
+
+        // Same translucency rule as the dynamic sprites
+        auto translucent = [](const SpriteRendererComponent& sprite) {
+            return Renderer2D::CPUAlphaZSorting && (sprite.texture || sprite.color.a < 1.0f);
+        };
+        auto depth = [](const Storage::Sprite& sprite) { return sprite.Transform[3].z; };
+
+        std::stable_sort(storage.Sprites.begin(), storage.Sprites.end(),
+                         [&](const Storage::Sprite& a, const Storage::Sprite& b) {
+                             const bool aTranslucent = translucent(a.Component);
+                             const bool bTranslucent = translucent(b.Component);
+                             if (aTranslucent != bTranslucent)
+                                 return bTranslucent;
+                             if (aTranslucent && depth(a) != depth(b))
+                                 return depth(a) < depth(b);
+                             if (a.Component.shader != b.Component.shader)
+                                 return (uint64_t)a.Component.shader < (uint64_t)b.Component.shader;
+                             return (uint64_t)a.Component.texture < (uint64_t)b.Component.texture;
+                         });
+
+        std::vector<QuadVertex> vertices(storage.Sprites.size() * 4);
+        Storage::Group* group = nullptr;
+        for (size_t i = 0; i < storage.Sprites.size(); i++) {
+            const Storage::Sprite& sprite = storage.Sprites[i];
+            const SpriteRendererComponent& component = sprite.Component;
+            Ref<Texture2D> texture = component.texture ? AssetManager::GetAsset<Texture2D>(component.texture) : nullptr;
+            const bool spriteTranslucent = translucent(component);
+
+            const bool fits = group && group->Shader == component.shader && group->Texture == texture &&
+                group->Translucent == spriteTranslucent && (!spriteTranslucent || group->Depth == depth(sprite)) &&
+                group->QuadCount < Renderer2DData::MaxQuads;
+            if (!fits) {
+                group = &storage.Groups.emplace_back();
+                group->FirstVertex = (uint32_t)i * 4;
+                group->Shader = component.shader;
+                group->Texture = texture;
+                group->Translucent = spriteTranslucent;
+            }
+
+            const float tilingFactor = texture && !component.shader ? component.tilingFactor : 1.0f;
+            QuadVertex* quad = &vertices[i * 4];
+            WriteQuadVertices(quad, sprite.Transform, component.color, tilingFactor, sprite.EntityID,
+                              component.uvRect);
+            for (uint32_t corner = 0; corner < 4; corner++)
+                quad[corner].TexIndex = texture ? 1.0f : 0.0f;
+
+            glm::vec2 depthBounds;
+            const glm::vec4 bounds = ViewCulling::GetQuadBounds(sprite.Transform, depthBounds);
+            group->Bounds = {
+                std::min(group->Bounds.x, bounds.x), std::min(group->Bounds.y, bounds.y),
+                std::max(group->Bounds.z, bounds.z), std::max(group->Bounds.w, bounds.w)
+            };
+            group->Depth = std::max(group->Depth, depth(sprite));
+            group->QuadCount++;
+        }
+
+        Ref<VertexBuffer> vertexBuffer = VertexBuffer::create((float*)vertices.data(),
+                                                              (uint32_t)(vertices.size() * sizeof(QuadVertex)));
+        vertexBuffer->setLayout(QuadVertexLayout());
+
+        storage.Mesh = VertexArray::create();
+        storage.Mesh->addVertexBuffer(vertexBuffer);
+        storage.Mesh->setIndexBuffer(s_Data.QuadVertexArray->getIndexBuffers());
+    }
+
+    void Renderer2D::DrawStaticBatch(const StaticSpriteBatch& batch) {
+        SHADO_PROFILE_FUNCTION();
+
+        const auto& storage = *batch.m_Storage;
+        if (!storage.Mesh)
+            return;
+
+        for (const auto& group : storage.Groups) {
+            if (s_Data.Culling && !ViewCulling::Overlaps(group.Bounds, s_Data.ViewRect))
+                continue;
+
+            if (FrameMeshesFull())
+                NextBatch();
+
+            PushMeshPacket(storage.Mesh, glm::mat4(1.0f), group.FirstVertex, group.QuadCount, group.Texture,
+                           group.Shader, group.Depth, group.Translucent);
+        }
+    }
+
+    // Tilemap chunks leave the entity ID out of their vertices, the whole tilemap shares one
+    using TileVertex = QuadVertexData;
+
+    /**
+     * Rebuilds the mesh of one tilemap chunk from its tiles and the current mesh settings of the tilemap.
+     * Vertices are in tilemap space, the transform is applied when the chunk is drawn
+     */
+    static void BuildTilemapChunk(TilemapComponent& tilemap, uint32_t chunkX, uint32_t chunkY) {
+        SHADO_PROFILE_FUNCTION();
+
+        constexpr uint32_t chunkSize = TilemapComponent::ChunkSize;
+        TilemapComponent::Chunk& chunk = tilemap.getChunk(chunkX, chunkY);
+        const TilemapComponent::MeshSettings& settings = tilemap.meshSettings;
+
+        // The mesh is kept when the chunk empties, painting into it again reuses the same buffers
+        chunk.meshQuadCount = 0;
+        chunk.meshRevision = chunk.revision;
+        chunk.meshSettingsRevision = tilemap.meshSettingsRevision;
+        if (chunk.tiles.empty())
+            return;
+
+        const glm::vec2 grid = glm::max(glm::vec2(settings.atlasGrid), glm::vec2(1.0f));
+        const float texIndex = settings.atlas ? 1.0f : 0.0f;
+        const glm::vec2 halfTile = 0.5f * settings.tileSize;
+
+        auto& vertices = s_Data.TilemapVertices;
+        vertices.resize(chunkSize * chunkSize * 4);
+        for (uint32_t y = 0; y < chunkSize; y++) {
+            for (uint32_t x = 0; x < chunkSize; x++) {
+                const uint16_t tile = chunk.tiles[y * chunkSize + x];
+                if (tile == 0)
+                    continue;
+
+                const float column = (float)((tile - 1) % (uint32_t)grid.x);
+                const float row = (float)((tile - 1) / (uint32_t)grid.x);
+                const glm::vec4 uvRect = {
+                    column / grid.x, 1.0f - (row + 1.0f) / grid.y,
+                    (column + 1.0f) / grid.x, 1.0f - row / grid.y
+                };
+
+                const glm::vec2 center = glm::vec2(chunkX * chunkSize + x, chunkY * chunkSize + y) * settings.tileSize;
+                const glm::vec2 corners[4] = {
+                    center - halfTile, {center.x + halfTile.x, center.y - halfTile.y},
+                    center + halfTile, {center.x - halfTile.x, center.y + halfTile.y}
+                };
+                const glm::vec2 textureCoords[4] = {
+                    {uvRect.x, uvRect.y}, {uvRect.z, uvRect.y}, {uvRect.z, uvRect.w}, {uvRect.x, uvRect.w}
+                };
+
+                TileVertex* quad = &vertices[chunk.meshQuadCount++ * 4];
+                for (uint32_t corner = 0; corner < 4; corner++) {
+                    quad[corner].Position = glm::vec3(corners[corner], 0.0f);
+                    quad[corner].Color = settings.color;
+                    quad[corner].TexCoord = textureCoords[corner];
+                    quad[corner].TexIndex = texIndex;
+                    quad[corner].TilingFactor = 1.0f;
+                }
+            }
+        }
+
+        if (chunk.meshQuadCount == 0)
+            return;
+
+        // Sized for a full chunk once, so editing tiles only rewrites the vertices
+        if (!chunk.mesh) {
+            const uint32_t capacity = (uint32_t)(chunkSize * chunkSize * 4 * sizeof(TileVertex));
+            Ref<VertexBuffer> vertexBuffer = VertexBuffer::create(capacity);
+            vertexBuffer->setLayout(BufferLayout(QuadVertexElements(), 0));
+
+            chunk.mesh = VertexArray::create();
+            chunk.mesh->addVertexBuffer(vertexBuffer);
+            chunk.mesh->setIndexBuffer(s_Data.QuadVertexArray->getIndexBuffers());
+        }
+
+        chunk.mesh->getVertexBuffers()[0]->setData(vertices.data(), chunk.meshQuadCount * 4 * sizeof(TileVertex));
+    }
+
+    // Clamps a range of tile coordinates, tile t covering [t - 0.5, t + 0.5], to the chunks it touches
+    static bool GetChunkRange(float minTile, float maxTile, uint32_t chunkCount, uint32_t& first, uint32_t& last) {
+        const float chunkSize = (float)TilemapComponent::ChunkSize;
+        const float firstChunk = std::floor((minTile + 0.5f) / chunkSize);
+        const float lastChunk = std::floor((maxTile + 0.5f) / chunkSize);
+        if (lastChunk < 0.0f || firstChunk >= (float)chunkCount)
+            return false;
+
+        first = (uint32_t)std::max(firstChunk, 0.0f);
+        last = (uint32_t)std::min(lastChunk, (float)(chunkCount - 1));
+        return true;
+    }
+
+    void Renderer2D::DrawTilemap(const glm::mat4& transform, TilemapComponent& tilemap, int entityID) {
+        SHADO_PROFILE_FUNCTION();
+
+        if (tilemap.getChunksX() == 0 || tilemap.getChunksY() == 0)
+            return;
+
+        const TilemapComponent::MeshSettings settings = {
+            tilemap.color, tilemap.tileSize, tilemap.atlasGrid, tilemap.atlas
+        };
+        if (!(settings == tilemap.meshSettings)) {
+            tilemap.meshSettings = settings;
+            tilemap.meshSettingsRevision++;
+        }
+
+        // Tile space to world xy. The view rectangle brought back into tile space bounds the chunks to look at,
+        // so a large map only pays for the chunks around the camera
+        const glm::mat2 axes = {
+            glm::vec2(transform[0]) * tilemap.tileSize.x, glm::vec2(transform[1]) * tilemap.tileSize.y
+        };
+        const glm::vec2 origin = transform[3];
+
+        uint32_t firstX = 0, firstY = 0;
+        uint32_t lastX = tilemap.getChunksX() - 1, lastY = tilemap.getChunksY() - 1;
+        const bool culling = s_Data.Culling && std::abs(glm::determinant(axes)) > 1e-12f;
+        if (culling) {
+            const glm::vec4& view = s_Data.ViewRect;
+            if (view.x > view.z || view.y > view.w)
+                return;
+
+            const glm::mat2 inverse = glm::inverse(axes);
+            glm::vec2 minTile = glm::vec2(FLT_MAX);
+            glm::vec2 maxTile = glm::vec2(-FLT_MAX);
+            for (const glm::vec2& corner : {glm::vec2(view.x, view.y), glm::vec2(view.z, view.y),
+                                            glm::vec2(view.x, view.w), glm::vec2(view.z, view.w)}) {
+                const glm::vec2 tile = inverse * (corner - origin);
+                minTile = glm::min(minTile, tile);
+                maxTile = glm::max(maxTile, tile);
+            }
+
+            if (!GetChunkRange(minTile.x, maxTile.x, tilemap.getChunksX(), firstX, lastX) ||
+                !GetChunkRange(minTile.y, maxTile.y, tilemap.getChunksY(), firstY, lastY))
+                return;
+        }
+
+        // Same translucency rule as the sprites
+        const bool translucent = CPUAlphaZSorting && (tilemap.atlas || tilemap.color.a < 1.0f);
+        Ref<Texture2D> atlas = tilemap.atlas ? AssetManager::GetAsset<Texture2D>(tilemap.atlas) : nullptr;
+
+        constexpr float chunkSize = (float)TilemapComponent::ChunkSize;
+        for (uint32_t chunkY = firstY; chunkY <= lastY; chunkY++) {
+            for (uint32_t chunkX = firstX; chunkX <= lastX; chunkX++) {
+                const glm::vec2 minCorner = glm::vec2(chunkX, chunkY) * chunkSize - 0.5f;
+                const glm::vec2 maxCorner = minCorner + chunkSize;
+
+                // The range is exact for axis aligned maps, rotated ones still test each chunk
+                if (culling) {
+                    const glm::vec3 corners[4] = {
+                        glm::vec3(axes * minCorner + origin, 0.0f),
+                        glm::vec3(axes * glm::vec2(maxCorner.x, minCorner.y) + origin, 0.0f),
+                        glm::vec3(axes * glm::vec2(minCorner.x, maxCorner.y) + origin, 0.0f),
+                        glm::vec3(axes * maxCorner + origin, 0.0f)
+                    };
+                    if (!ViewCulling::Overlaps(ViewCulling::GetBounds(corners, 4), s_Data.ViewRect))
+                        continue;
+                }
+
+                TilemapComponent::Chunk& chunk = tilemap.getChunk(chunkX, chunkY);
+                if (chunk.meshRevision != chunk.revision || chunk.meshSettingsRevision != tilemap.meshSettingsRevision)
+                    BuildTilemapChunk(tilemap, chunkX, chunkY);
+                if (chunk.meshQuadCount == 0)
+                    continue;
+
+                if (FrameMeshesFull())
+                    NextBatch();
+
+                // Chunks sort at the depth of their center like a sprite would
+                const glm::vec2 center = 0.5f * (minCorner + maxCorner) * tilemap.tileSize;
+                const float depth = (transform * glm::vec4(center, 0.0f, 1.0f)).z;
+                PushMeshPacket(chunk.mesh, transform, 0, chunk.meshQuadCount, atlas, 0, depth, translucent, entityID);
             }
-            else
-                DrawQuad(transform, src.color, entityID);
         }
     }
 
@@ -808,8 +2313,12 @@ namespace Shado {
         {
             return;
         }
-        
-        s_Data.FontAtlasTexture = fontAtlas;
+
+        if (FrameTexturesFull())
+            NextBatch();
+
+        uint16_t fontAtlasIndex = GetFrameTextureIndex(fontAtlas);
+        const float depth = transform[3].z;
 
         double x = 0.0;
         double fsScale = 1.0 / (metrics.ascenderY - metrics.descenderY);
@@ -872,33 +2381,54 @@ namespace Shado {
             texCoordMin *= glm::vec2(texelWidth, texelHeight);
             texCoordMax *= glm::vec2(texelWidth, texelHeight);
 
-            // render here
-            s_Data.TextVertexBufferPtr->Position = transform * glm::vec4(quadMin, 0.0f, 1.0f);
-            s_Data.TextVertexBufferPtr->Color = textRenderer.color;
-            s_Data.TextVertexBufferPtr->TexCoord = texCoordMin;
-            s_Data.TextVertexBufferPtr->EntityID = entityID;
-            s_Data.TextVertexBufferPtr++;
-
-            s_Data.TextVertexBufferPtr->Position = transform * glm::vec4(quadMin.x, quadMax.y, 0.0f, 1.0f);
-            s_Data.TextVertexBufferPtr->Color = textRenderer.color;
-            s_Data.TextVertexBufferPtr->TexCoord = {texCoordMin.x, texCoordMax.y};
-            s_Data.TextVertexBufferPtr->EntityID = entityID;
-            s_Data.TextVertexBufferPtr++;
-
-            s_Data.TextVertexBufferPtr->Position = transform * glm::vec4(quadMax, 0.0f, 1.0f);
-            s_Data.TextVertexBufferPtr->Color = textRenderer.color;
-            s_Data.TextVertexBufferPtr->TexCoord = texCoordMax;
-            s_Data.TextVertexBufferPtr->EntityID = entityID;
-            s_Data.TextVertexBufferPtr++;
-
-            s_Data.TextVertexBufferPtr->Position = transform * glm::vec4(quadMax.x, quadMin.y, 0.0f, 1.0f);
-            s_Data.TextVertexBufferPtr->Color = textRenderer.color;
-            s_Data.TextVertexBufferPtr->TexCoord = {texCoordMax.x, texCoordMin.y};
-            s_Data.TextVertexBufferPtr->EntityID = entityID;
-            s_Data.TextVertexBufferPtr++;
-
-            s_Data.TextIndexCount += 6;
-            s_Data.Stats.QuadCount++;
+            const glm::vec3 corners[4] = {
+                transform * glm::vec4(quadMin, 0.0f, 1.0f),
+                transform * glm::vec4(quadMin.x, quadMax.y, 0.0f, 1.0f),
+                transform * glm::vec4(quadMax, 0.0f, 1.0f),
+                transform * glm::vec4(quadMax.x, quadMin.y, 0.0f, 1.0f)
+            };
+
+            // Glyphs outside the view are skipped one by one, text has no bounds before it is laid out
+            if (!s_Data.Culling || ViewCulling::Overlaps(ViewCulling::GetBounds(corners, 4), s_Data.ViewRect)) {
+                if (s_Data.TextIndexCount >= Renderer2DData::MaxIndices) {
+                    NextBatch();
+                    fontAtlasIndex = GetFrameTextureIndex(fontAtlas);
+                }
+
+                // Text is anti-aliased so it always blends. Glyphs share a key, the stable sort keeps order
+                s_Data.Packets[s_Data.PacketCount++] = {
+                    MakeSortKey(TextPipeline, fontAtlasIndex, depth, CPUAlphaZSorting),
+                    (uint32_t)(s_Data.TextVertexBufferPtr - s_Data.TextVertexBufferBase), fontAtlasIndex,
+                    DrawPacketType::Text
+                };
+
+                s_Data.TextVertexBufferPtr->Position = corners[0];
+                s_Data.TextVertexBufferPtr->Color = textRenderer.color;
+                s_Data.TextVertexBufferPtr->TexCoord = texCoordMin;
+                s_Data.TextVertexBufferPtr->setEntityID(entityID);
+                s_Data.TextVertexBufferPtr++;
+
+                s_Data.TextVertexBufferPtr->Position = corners[1];
+                s_Data.TextVertexBufferPtr->Color = textRenderer.color;
+                s_Data.TextVertexBufferPtr->TexCoord = {texCoordMin.x, texCoordMax.y};
+                s_Data.TextVertexBufferPtr->setEntityID(entityID);
+                s_Data.TextVertexBufferPtr++;
+
+                s_Data.TextVertexBufferPtr->Position = corners[2];
+                s_Data.TextVertexBufferPtr->Color = textRenderer.color;
+                s_Data.TextVertexBufferPtr->TexCoord = texCoordMax;
+                s_Data.TextVertexBufferPtr->setEntityID(entityID);
+                s_Data.TextVertexBufferPtr++;
+
+                s_Data.TextVertexBufferPtr->Position = corners[3];
+                s_Data.TextVertexBufferPtr->Color = textRenderer.color;
+                s_Data.TextVertexBufferPtr->TexCoord = {texCoordMax.x, texCoordMin.y};
+                s_Data.TextVertexBufferPtr->setEntityID(entityID);
+                s_Data.TextVertexBufferPtr++;
+
+                s_Data.TextIndexCount += 6;
+                s_Data.Stats.QuadCount++;
+            }
 
             if (i < string.size() - 1) {
                 double advance = glyph->getAdvance();
@@ -927,18 +2457,28 @@ namespace Shado {
         return s_Data.Stats;
     }
 
-    void Renderer2D::CmdDrawIndexed(const Ref<VertexArray>& vertexArray, uint32_t indexCount) {
+    void Renderer2D::CmdDrawIndexed(const Ref<VertexArray>& vertexArray, uint32_t indexCount, uint32_t baseVertex) {
         SHADO_PROFILE_FUNCTION();
 
         vertexArray->bind();
         uint32_t count = indexCount ? indexCount : vertexArray->getIndexBuffers()->getCount();
-        glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT, nullptr);
+        glDrawElementsBaseVertex(GL_TRIANGLES, count, GL_UNSIGNED_INT, nullptr, (GLint)baseVertex);
+    }
+
+    void Renderer2D::CmdDrawIndexedInstanced(const Ref<VertexArray>& vertexArray, uint32_t indexCount,
+                                             uint32_t instanceCount, uint32_t baseInstance) {
+        SHADO_PROFILE_FUNCTION();
+
+        vertexArray->bind();
+        glDrawElementsInstancedBaseInstance(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, nullptr, instanceCount,
+                                            baseInstance);
     }
 
-    void Renderer2D::CmdDrawIndexedLine(const Ref<VertexArray>& vertexArray, uint32_t vertexCount) {
+    void Renderer2D::CmdDrawIndexedLine(const Ref<VertexArray>& vertexArray, uint32_t vertexCount,
+                                        uint32_t firstVertex) {
         SHADO_PROFILE_FUNCTION();
 
         vertexArray->bind();
-        glDrawArrays(GL_LINES, 0, vertexCount);
+        glDrawArrays(GL_LINES, (GLint)firstVertex, vertexCount);
     }
 }
@@ -8,18 +8,106 @@
 #include "cameras/OrthoCamera.h"
 #include "Shader.h"
 #include "VertexArray.h"
+#include <functional>
+#include <span>
 
 namespace Shado {
     struct SpriteRendererComponent;
     struct TextComponent;
+    struct TilemapComponent;
+    struct DrawPacket;
+    enum class DrawPacketType : uint8_t;
 
     inline const std::filesystem::path QUAD_SHADER = "assets/shaders/Renderer2D_Quad.glsl";
     inline const std::filesystem::path CIRCLE_SHADER = "assets/shaders/Renderer2D_Circle.glsl";
     inline const std::filesystem::path LINES_SHADER = "assets/shaders/Renderer2D_Line.glsl";
+    inline const std::filesystem::path QUAD_INSTANCED_SHADER = "assets/shaders/Renderer2D_QuadInstanced.glsl";
+
+    struct Renderer2DSpecification {
+        // Submit quads as one compact per-instance record expanded in the vertex shader,
+        // instead of four pre-transformed vertices
+        bool InstancedQuads = false;
+    };
+
+    /**
+     * Quads as parallel arrays, e.g. straight from a particle pool. Every span but the positions and sizes
+     * may be left empty
+     */
+    struct QuadBatch {
+        std::span<const float> PositionX, PositionY;
+        std::span<const float> PositionZ; // Empty for z = 0
+        std::span<const float> SizeX, SizeY;
+        std::span<const float> Rotation; // Around Z, in radians. Empty for axis aligned quads
+        std::span<const glm::vec4> Colors; // One per quad, or a single color for all of them. Empty for white
+        std::span<const int> EntityIDs; // Empty for -1
+        AssetHandle Texture = 0;
+    };
+
+    /**
+     * Thread-local batch builder. Generates the vertices of sprites without touching the shared renderer state,
+     * so several recorders can be filled in parallel. Renderer2D::Submit merges one into the frame
+     */
+    class Renderer2DRecorder {
+    public:
+        Renderer2DRecorder();
+        ~Renderer2DRecorder();
+
+        void drawSprite(const glm::mat4& transform, const SpriteRendererComponent& sprite, int entityID);
+
+        /**
+         * Same as Renderer2D::IsVisible, counted in the recorder until Submit adds it to the stats
+         */
+        bool isVisible(const glm::vec4& bounds);
+
+        /**
+         * Drops the recorded sprites. The storage is kept, so recording the same scene again does not allocate
+         */
+        void reset();
+
+    private:
+        struct Storage;
+        ScopedRef<Storage> m_Storage;
+
+        friend class Renderer2D;
+    };
+
+    /**
+     * Sprites baked once into a GPU vertex buffer of their own, grouped by shader and texture.
+     * Renderer2D::DrawStaticBatch queues the groups every frame without any CPU vertex work.
+     * Rebuild the batch when one of its sprites changes
+     */
+    class StaticSpriteBatch {
+    public:
+        StaticSpriteBatch();
+        ~StaticSpriteBatch();
+
+        /**
+         * Drops the sprites of the previous bake. The baked groups are still drawn until build is called
+         */
+        void clear();
+        void addSprite(const glm::mat4& transform, const SpriteRendererComponent& sprite, int entityID);
+
+        /**
+         * Sorts the added sprites into draw groups and uploads their vertices. Main thread only
+         */
+        void build();
+
+        uint32_t getSpriteCount() const;
+
+    private:
+        struct Storage;
+        ScopedRef<Storage> m_Storage;
+
+        friend class Renderer2D;
+    };
 
     class Renderer2D {
     public:
-        static void Init();
+        /**
+         * Must be called before the Application initializes the renderer (i.e., before the first layer is
+         * submitted) to use a non-default specification
+         */
+        static void Init(const Renderer2DSpecification& specification = {});
         static void Shutdown();
 
         static void BeginScene(const Camera& camera, const glm::mat4& transform);
@@ -40,12 +128,29 @@ namespace Shado {
         static void DrawQuad(const glm::mat4& transform, const glm::vec4& color, int entityID = -1);
         static void DrawQuad(const glm::mat4& transform, AssetHandle textureHandle, float tilingFactor = 1.0f,
                              const glm::vec4& tintColor = glm::vec4(1.0f), int entityID = -1);
+        /**
+         * For textures that are not assets (render targets, font atlases, generated textures)
+         */
+        static void DrawQuad(const glm::mat4& transform, const Ref<Texture2D>& texture, float tilingFactor = 1.0f,
+                             const glm::vec4& tintColor = glm::vec4(1.0f), int entityID = -1);
         static void DrawQuad(const glm::mat4& transform, AssetHandle shaderHandle,
-                             const glm::vec4& color = {1, 1, 1, 1},
-                             int entityID = -1, float textureIndex = 0.0f);
+                             const glm::vec4& color = {1, 1, 1, 1}, int entityID = -1);
         static void DrawQuad(const glm::mat4& transform, AssetHandle textureHandle, AssetHandle shaderHandle,
                              const glm::vec4& color = {1, 1, 1, 1}, int entityID = -1);
 
+        /**
+         * Bulk version of DrawQuad. The batch capacity is checked once per span (or once per batch the span
+         * fills) and the corners are written straight into the staging buffer
+         * @param colors One per transform, or a single color for all of them
+         * @param entityIDs One per transform, or empty for -1
+         */
+        static void DrawQuads(std::span<const glm::mat4> transforms, std::span<const glm::vec4> colors,
+                              std::span<const int> entityIDs = {});
+        static void DrawQuads(std::span<const glm::mat4> transforms, AssetHandle textureHandle,
+                              std::span<const glm::vec4> tintColors, float tilingFactor = 1.0f,
+                              std::span<const int> entityIDs = {});
+        static void DrawQuads(const QuadBatch& quads);
+
         static void DrawRotatedQuad(const glm::vec2& position, const glm::vec2& size, const glm::vec3& rotation,
                                     const glm::vec4& color);
         static void DrawRotatedQuad(const glm::vec3& position, const glm::vec2& size, const glm::vec3& rotation,
@@ -69,14 +174,66 @@ namespace Shado {
 
         static void DrawSprite(const glm::mat4& transform, SpriteRendererComponent& src, int entityID);
 
+        /**
+         * Queues the baked groups as sort-keyed packets, so they order against the dynamic primitives.
+         * Groups outside the culling view are skipped
+         */
+        static void DrawStaticBatch(const StaticSpriteBatch& batch);
+
+        /**
+         * Queues the chunks of a tilemap that intersect the culling view as sort-keyed packets, each at the
+         * depth of its center. Chunk meshes are built the first time they are seen and rebuilt only after one
+         * of their tiles or the look of the tilemap changed, the transform is applied at draw time
+         */
+        static void DrawTilemap(const glm::mat4& transform, TilemapComponent& tilemap, int entityID = -1);
+
+        /**
+         * @return The recorder of a worker. Recorders are created on first use and live until Shutdown.
+         * Main thread only, fetch every recorder before handing them to workers
+         */
+        static Renderer2DRecorder& GetRecorder(uint32_t index);
+
+        /**
+         * Runs job for recorders 0 to recorderCount - 1 in parallel and returns once every one of them is done.
+         * Recorder 0 runs on the calling thread, the others on worker threads started on first use and kept
+         * until Shutdown. Main thread only
+         */
+        static void RecordParallel(uint32_t recorderCount,
+                                   const std::function<void(Renderer2DRecorder& recorder, uint32_t index)>& job);
+
+        /**
+         * Merges a recorder into the frame, as if its sprites were drawn one by one in recording order.
+         * Main thread only, between BeginScene and EndScene
+         */
+        static void Submit(Renderer2DRecorder& recorder);
+
         static void DrawString(const glm::mat4& transform, const TextComponent& textRenderer,
                                int entityID = -1);
 
+        /**
+         * Enables view culling for the rest of the scene. The view rectangle is taken from the camera of
+         * BeginScene, cut to the depths the content lies between. Main thread only, after BeginScene
+         */
+        static void SetCullingDepthRange(float minZ, float maxZ);
+
+        /**
+         * Tests world bounds (min xy, max xy) against the view rectangle and counts the result in the stats.
+         * Everything is visible until SetCullingDepthRange is called
+         */
+        static bool IsVisible(const glm::vec4& bounds);
+
         static float GetLineWidth();
         static void SetLineWidth(float width);
 
         static void setCPUAlphaZSorting(bool b) { CPUAlphaZSorting = b; }
 
+        /**
+         * Sets the layer of the following draws. Layers are drawn in ascending order, before depth
+         * and material are considered. Reset to 0 on BeginScene
+         * @param layer Layer index, from 0 to 15
+         */
+        static void SetLayer(uint32_t layer);
+
         static bool hasInitialized() { return s_Init; }
 
 
@@ -85,6 +242,9 @@ namespace Shado {
             uint32_t DrawCalls = 0;
             uint32_t QuadCount = 0;
             uint32_t LineCount = 0;
+            uint64_t UploadedBytes = 0; // Vertex and instance data sent to the GPU
+            uint32_t VisibleCount = 0; // Entities that passed the view culling test
+            uint32_t CulledCount = 0; // Entities skipped before any vertex was generated
 
             uint32_t GetTotalVertexCount() { return QuadCount * 4 + LineCount * 2; }
             uint32_t GetTotalIndexCount() { return QuadCount * 6 + LineCount * 2; }
@@ -94,14 +254,37 @@ namespace Shado {
         static Statistics GetStats();
 
     private:
-        static void CmdDrawIndexed(const Ref<VertexArray>& vertexArray, uint32_t indexCount = 0);
-        static void CmdDrawIndexedLine(const Ref<VertexArray>& vertexArray, uint32_t indexCount = 0);
+        static void CmdDrawIndexed(const Ref<VertexArray>& vertexArray, uint32_t indexCount = 0,
+                                   uint32_t baseVertex = 0);
+        static void CmdDrawIndexedInstanced(const Ref<VertexArray>& vertexArray, uint32_t indexCount,
+                                            uint32_t instanceCount, uint32_t baseInstance = 0);
+        static void CmdDrawIndexedLine(const Ref<VertexArray>& vertexArray, uint32_t indexCount = 0,
+                                       uint32_t firstVertex = 0);
         inline static bool s_Init = false;
         inline static bool CPUAlphaZSorting = true;
 
+        friend class Renderer2DRecorder;
+        friend class StaticSpriteBatch;
+
     private:
         static void StartBatch();
         static void NextBatch();
+        static void FlushPackets();
+        static void StartLineBatch();
+        static void FlushLines();
+        static void MapBatch(DrawPacketType type);
+        static void EmitPacket(const DrawPacket& packet);
+        static void FlushBatch();
+        static uint32_t ReserveQuads(size_t count);
+        static void DrawTexturedQuad(const glm::mat4& transform, uint16_t frameTexture, float tilingFactor,
+                                     const glm::vec4& tintColor, int entityID,
+                                     const glm::vec4& uvRect = {0.0f, 0.0f, 1.0f, 1.0f});
+        static bool DrawQuadInstance(const glm::mat4& transform, const glm::vec4& color, uint16_t frameTexture,
+                                     float tilingFactor, int entityID, bool translucent,
+                                     const glm::vec4& uvRect = {0.0f, 0.0f, 1.0f, 1.0f});
+        static void DrawShaderQuad(const glm::mat4& transform, AssetHandle shaderHandle, uint16_t frameTexture,
+                                   const glm::vec4& color, int entityID, bool translucent,
+                                   const glm::vec4& uvRect = {0.0f, 0.0f, 1.0f, 1.0f});
     };
 }
 
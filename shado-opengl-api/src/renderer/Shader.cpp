@@ -2,7 +2,10 @@
 #include <GL/glew.h>
 #include <fstream>
 #include <array>
+#include <algorithm>
 
+#include "ShaderCache.h"
+#include "VertexPolicy.h"
 #include "debug/Debug.h"
 #include "glm/gtc/type_ptr.hpp"
 
@@ -15,14 +18,64 @@ namespace Shado {
         return 0;
     }
 
-    Shader::Shader(const std::string& fileContent) {
+    // Build configuration visible to every stage, e.g. whether the Renderer2D vertices carry entity IDs
+    static const std::string s_BuildDefines =
+        "#define SHADO_EDITOR_DATA " + std::to_string(SHADO_EDITOR_DATA) + "\n";
+
+    /** Inserts the build defines right after the #version directive, which must stay the first statement */
+    static std::string InjectBuildDefines(const std::string& stageSource) {
+        size_t version = stageSource.find("#version");
+        if (version == std::string::npos)
+            return s_BuildDefines + stageSource;
+
+        size_t eol = stageSource.find('\n', version);
+        if (eol == std::string::npos)
+            return stageSource + "\n" + s_BuildDefines;
+
+        std::string result = stageSource;
+        result.insert(eol + 1, s_BuildDefines);
+        return result;
+    }
+
+    // Shaders whose link was issued but not yet checked. Polled once per frame by PollPendingCompilations
+    static std::vector<Shader*> s_PendingShaders;
+    static std::mutex s_PendingMutex;
+
+    static bool HasParallelCompile() {
+        static const bool s_Supported = [] {
+            if (GLEW_KHR_parallel_shader_compile) {
+                glMaxShaderCompilerThreadsKHR(0xFFFFFFFF); // Let the driver pick
+                return true;
+            }
+            if (GLEW_ARB_parallel_shader_compile) {
+                glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+                return true;
+            }
+            return false;
+        }();
+        return s_Supported;
+    }
+
+    Shader::Shader(const std::string& fileContent, bool async) {
         // Shader sometimes crash because of std::async in ContentBrowserPanel, so we'll make it thread safe
         static std::mutex s_Mutex;
         std::lock_guard<std::mutex> lock(s_Mutex);
 
         const std::string& source = fileContent;
-        auto shaderSources = preProcess(source);
-        compile(shaderSources);
+        m_CacheKey = ShaderCache::GetKey(s_BuildDefines + source);
+        if (!loadCachedProgram(m_CacheKey)) {
+            auto shaderSources = preProcess(source);
+            if (async) {
+                link(shaderSources);
+                m_Pending = true;
+
+                std::lock_guard<std::mutex> pendingLock(s_PendingMutex);
+                s_PendingShaders.push_back(this);
+            }
+            else {
+                compile(shaderSources);
+            }
+        }
 
         // See if the vertex Shader constains the basic uniforms	
         std::vector<std::string> requiredUniforms{"u_ViewProjection", "u_Transform", "a_Position"};
@@ -38,10 +91,21 @@ namespace Shado {
         std::unordered_map<GLenum, std::string> sources;
         sources[GL_VERTEX_SHADER] = vertexSrc;
         sources[GL_FRAGMENT_SHADER] = fragmentSrc;
-        compile(sources);
+
+        m_CacheKey = ShaderCache::GetKey(vertexSrc + fragmentSrc);
+        if (!loadCachedProgram(m_CacheKey))
+            compile(sources);
     }
 
     Shader::~Shader() {
+        if (m_Pending) {
+            std::lock_guard<std::mutex> lock(s_PendingMutex);
+            std::erase(s_PendingShaders, this);
+
+            for (uint32_t id : m_PendingShaderIDs)
+                glDeleteShader(id);
+        }
+
         glDeleteProgram(m_Renderer2DID);
 
         // delete custom uniforms
@@ -95,21 +159,27 @@ namespace Shado {
                 throw ShaderCompilationException("Syntax error");
             pos = source.find(typeToken, nextLinePos); //Start of next shader type declaration line
 
-            shaderSources[ShaderTypeFromString(type)] = (pos == std::string::npos)
+            shaderSources[ShaderTypeFromString(type)] = InjectBuildDefines((pos == std::string::npos)
                                                             ? source.substr(nextLinePos)
-                                                            : source.substr(nextLinePos, pos - nextLinePos);
+                                                            : source.substr(nextLinePos, pos - nextLinePos));
         }
 
         return shaderSources;
     }
 
     void Shader::compile(const std::unordered_map<GLenum, std::string>& shaderSources) {
-        GLuint program = glCreateProgram();
+        link(shaderSources);
+        finishLink();
+    }
+
+    void Shader::link(const std::unordered_map<GLenum, std::string>& shaderSources) {
         if (shaderSources.size() > 2)
             throw ShaderCompilationException("We only support 2 shaders for now");
 
-        std::array<GLenum, 2> glShaderIDs;
-        int glShaderIDIndex = 0;
+        // Issue everything before querying any status. With parallel shader compile the driver
+        // works on its own threads until the first status query, which finishLink defers
+        HasParallelCompile();
+        GLuint program = glCreateProgram();
         for (auto& kv : shaderSources) {
             GLenum type = kv.first;
             const std::string& source = kv.second;
@@ -121,32 +191,52 @@ namespace Shado {
 
             glCompileShader(shader);
 
+            glAttachShader(program, shader);
+            m_PendingShaderIDs.push_back(shader);
+        }
+
+        m_Renderer2DID = program;
+
+        // Link our program
+        ShaderCache::PrepareProgram(program);
+        glLinkProgram(program);
+    }
+
+    void Shader::finishLink() {
+        const GLuint program = m_Renderer2DID;
+        std::vector<uint32_t> shaderIDs = std::move(m_PendingShaderIDs);
+        m_PendingShaderIDs.clear();
+
+        auto deleteShaders = [&]() {
+            for (auto id : shaderIDs) {
+                glDetachShader(program, id);
+                glDeleteShader(id);
+            }
+        };
+
+        for (auto shader : shaderIDs) {
             GLint isCompiled = 0;
             glGetShaderiv(shader, GL_COMPILE_STATUS, &isCompiled);
             if (isCompiled == GL_FALSE) {
                 GLint maxLength = 0;
                 glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &maxLength);
 
-                std::vector<GLchar> infoLog(maxLength);
+                std::vector<GLchar> infoLog(std::max(maxLength, 1));
                 glGetShaderInfoLog(shader, maxLength, &maxLength, &infoLog[0]);
 
-                glDeleteShader(shader);
+                GLint type = 0;
+                glGetShaderiv(shader, GL_SHADER_TYPE, &type);
+
+                deleteShaders();
+                glDeleteProgram(program);
+                m_Renderer2DID = 0;
 
                 std::string errorMessage = "Shader compilation failure: " + std::to_string(type) + (
                     !infoLog.empty() ? infoLog.data() : "");
                 throw ShaderCompilationException(errorMessage);
-                break;
             }
-
-            glAttachShader(program, shader);
-            glShaderIDs[glShaderIDIndex++] = shader;
         }
 
-        m_Renderer2DID = program;
-
-        // Link our program
-        glLinkProgram(program);
-
         // Note the different functions here: glGetProgram* instead of glGetShader*.
         GLint isLinked = 0;
         glGetProgramiv(program, GL_LINK_STATUS, (int*)&isLinked);
@@ -155,25 +245,142 @@ namespace Shado {
             glGetProgramiv(program, GL_INFO_LOG_LENGTH, &maxLength);
 
             // The maxLength includes the NULL character
-            std::vector<GLchar> infoLog(maxLength);
+            std::vector<GLchar> infoLog(std::max(maxLength, 1));
             glGetProgramInfoLog(program, maxLength, &maxLength, &infoLog[0]);
 
             // We don't need the program anymore.
+            deleteShaders();
             glDeleteProgram(program);
-
-            for (auto id : glShaderIDs)
-                glDeleteShader(id);
+            m_Renderer2DID = 0;
 
             throw ShaderCompilationException("Shader link failure: " + std::string(infoLog.data()));
+        }
+
+        deleteShaders();
+        reflect();
+        ShaderCache::Store(m_CacheKey, program);
+    }
+
+    bool Shader::isReady() const {
+        return !m_Pending && !m_Failed;
+    }
+
+    void Shader::resolvePending() {
+        if (!m_Pending)
             return;
+
+        {
+            std::lock_guard<std::mutex> lock(s_PendingMutex);
+            std::erase(s_PendingShaders, this);
         }
+        m_Pending = false;
 
-        for (auto id : glShaderIDs) {
-            glDetachShader(program, id);
-            glDeleteShader(id);
+        try {
+            finishLink();
+        }
+        catch (const ShaderCompilationException& e) {
+            // Nothing up the stack expects the exception anymore, the renderer keeps using its fallback
+            SHADO_CORE_ERROR("Async shader compilation failed: {0}", e.what());
+            m_Failed = true;
+            m_CompileError = e.what();
         }
     }
 
+    void Shader::PollPendingCompilations() {
+        std::vector<Shader*> ready;
+        {
+            std::lock_guard<std::mutex> lock(s_PendingMutex);
+            for (Shader* shader : s_PendingShaders) {
+                if (HasParallelCompile()) {
+                    GLint completed = GL_FALSE;
+                    glGetProgramiv(shader->m_Renderer2DID, GL_COMPLETION_STATUS_KHR, &completed);
+                    if (completed)
+                        ready.push_back(shader);
+                }
+                // Without the extension any status query blocks, so give the driver a full frame first
+                else if (shader->m_PendingFrames++ > 0) {
+                    ready.push_back(shader);
+                }
+            }
+        }
+
+        for (Shader* shader : ready)
+            shader->resolvePending();
+    }
+
+    // Types the editor and the setters understand. Anything else (images, unsigned, other samplers) is still
+    // cached by location but reported as None instead of tripping the assert in ShaderDataTypeFromGLType
+    static ShaderDataType ReflectedUniformType(GLenum type) {
+        switch (type) {
+        case GL_FLOAT: case GL_FLOAT_VEC2: case GL_FLOAT_VEC3: case GL_FLOAT_VEC4:
+        case GL_INT: case GL_INT_VEC2: case GL_INT_VEC3: case GL_INT_VEC4:
+        case GL_BOOL: case GL_FLOAT_MAT3: case GL_FLOAT_MAT4: case GL_SAMPLER_2D:
+            return ShaderDataTypeFromGLType(type);
+        default:
+            return ShaderDataType::None;
+        }
+    }
+
+    void Shader::reflect() {
+        m_Uniforms.clear();
+
+        GLint count = 0, maxNameLength = 0;
+        glGetProgramiv(m_Renderer2DID, GL_ACTIVE_UNIFORMS, &count);
+        glGetProgramiv(m_Renderer2DID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+
+        std::vector<GLchar> name(std::max(maxNameLength, 1));
+        for (GLint i = 0; i < count; i++) {
+            GLsizei length = 0;
+            GLint size = 0;
+            GLenum type = 0;
+            glGetActiveUniform(m_Renderer2DID, (GLuint)i, (GLsizei)name.size(), &length, &size, &type, name.data());
+
+            // Arrays are reported as "name[0]", key them by their declared name
+            std::string uniformName(name.data(), length);
+            if (size_t bracket = uniformName.find('['); bracket != std::string::npos)
+                uniformName.resize(bracket);
+
+            // Block members have no location, their values come from the bound uniform buffer
+            GLint location = glGetUniformLocation(m_Renderer2DID, uniformName.c_str());
+            if (location < 0)
+                continue;
+
+            m_Uniforms[HashUniformName(uniformName)] = {uniformName, location, size, ReflectedUniformType(type)};
+        }
+    }
+
+    const Shader::UniformInfo* Shader::findUniform(uint32_t nameHash) const {
+        auto it = m_Uniforms.find(nameHash);
+        return it != m_Uniforms.end() ? &it->second : nullptr;
+    }
+
+    int32_t Shader::getLocation(uint32_t nameHash) {
+        ensureLinked();
+        if (m_Failed)
+            return -1;
+
+        const UniformInfo* info = findUniform(nameHash);
+        return info ? info->Location : -1;
+    }
+
+    void Shader::ensureLinked() {
+        // Anything touching the program itself has to wait for the link
+        if (m_Pending)
+            resolvePending();
+    }
+
+    bool Shader::loadCachedProgram(uint64_t cacheKey) {
+        GLuint program = glCreateProgram();
+        if (!ShaderCache::Load(cacheKey, program)) {
+            glDeleteProgram(program);
+            return false;
+        }
+
+        m_Renderer2DID = program;
+        reflect();
+        return true;
+    }
+
     int Shader::getCurrentActiveProgram() {
         GLint prog = 0;
         glGetIntegerv(GL_CURRENT_PROGRAM, &prog);
@@ -230,70 +437,122 @@ namespace Shado {
     }
 
     void Shader::setInt(const std::string& name, int value) {
-        GLint location = glGetUniformLocation(m_Renderer2DID, name.c_str());
-        glProgramUniform1i(m_Renderer2DID, location, value);
+        setInt(HashUniformName(name), value);
     }
 
     void Shader::setIntArray(const std::string& name, int* values, uint32_t count) {
-        GLint location = glGetUniformLocation(m_Renderer2DID, name.c_str());
-        glProgramUniform1iv(m_Renderer2DID, location, count, values);
+        setIntArray(HashUniformName(name), values, count);
     }
 
     void Shader::setFloat(const std::string& name, float value) {
-        GLint location = glGetUniformLocation(m_Renderer2DID, name.c_str());
-        glProgramUniform1f(m_Renderer2DID, location, value);
+        setFloat(HashUniformName(name), value);
     }
 
     void Shader::setFloat2(const std::string& name, const glm::vec2& value) {
-        GLint location = glGetUniformLocation(m_Renderer2DID, name.c_str());
-        glProgramUniform2f(m_Renderer2DID, location, value.x, value.y);
+        setFloat2(HashUniformName(name), value);
     }
 
     void Shader::setFloat3(const std::string& name, const glm::vec3& value) {
-        GLint location = glGetUniformLocation(m_Renderer2DID, name.c_str());
-        glProgramUniform3f(m_Renderer2DID, location, value.x, value.y, value.z);
+        setFloat3(HashUniformName(name), value);
     }
 
     void Shader::setFloat4(const std::string& name, const glm::vec4& value) {
-        GLint location = glGetUniformLocation(m_Renderer2DID, name.c_str());
-        glProgramUniform4f(m_Renderer2DID, location, value.x, value.y, value.z, value.w);
+        setFloat4(HashUniformName(name), value);
     }
 
     void Shader::setMat3(const std::string& name, const glm::mat3& value) {
-        GLint location = glGetUniformLocation(m_Renderer2DID, name.c_str());
-        glProgramUniformMatrix3fv(m_Renderer2DID, location, 1, GL_FALSE, glm::value_ptr(value));
+        setMat3(HashUniformName(name), value);
     }
 
     void Shader::setMat4(const std::string& name, const glm::mat4& value) {
-        GLint location = glGetUniformLocation(m_Renderer2DID, name.c_str());
+        setMat4(HashUniformName(name), value);
+    }
+
+    // Unknown names and failed programs have no location, skip the call instead of erroring on program 0
+    void Shader::setInt(uint32_t nameHash, int value) {
+        const int32_t location = getLocation(nameHash);
+        if (location < 0)
+            return;
+
+        glProgramUniform1i(m_Renderer2DID, location, value);
+    }
+
+    void Shader::setIntArray(uint32_t nameHash, int* values, uint32_t count) {
+        const int32_t location = getLocation(nameHash);
+        if (location < 0)
+            return;
+
+        glProgramUniform1iv(m_Renderer2DID, location, count, values);
+    }
+
+    void Shader::setFloat(uint32_t nameHash, float value) {
+        const int32_t location = getLocation(nameHash);
+        if (location < 0)
+            return;
+
+        glProgramUniform1f(m_Renderer2DID, location, value);
+    }
+
+    void Shader::setFloat2(uint32_t nameHash, const glm::vec2& value) {
+        const int32_t location = getLocation(nameHash);
+        if (location < 0)
+            return;
+
+        glProgramUniform2f(m_Renderer2DID, location, value.x, value.y);
+    }
+
+    void Shader::setFloat3(uint32_t nameHash, const glm::vec3& value) {
+        const int32_t location = getLocation(nameHash);
+        if (location < 0)
+            return;
+
+        glProgramUniform3f(m_Renderer2DID, location, value.x, value.y, value.z);
+    }
+
+    void Shader::setFloat4(uint32_t nameHash, const glm::vec4& value) {
+        const int32_t location = getLocation(nameHash);
+        if (location < 0)
+            return;
+
+        glProgramUniform4f(m_Renderer2DID, location, value.x, value.y, value.z, value.w);
+    }
+
+    void Shader::setMat3(uint32_t nameHash, const glm::mat3& value) {
+        const int32_t location = getLocation(nameHash);
+        if (location < 0)
+            return;
+
+        glProgramUniformMatrix3fv(m_Renderer2DID, location, 1, GL_FALSE, glm::value_ptr(value));
+    }
+
+    void Shader::setMat4(uint32_t nameHash, const glm::mat4& value) {
+        const int32_t location = getLocation(nameHash);
+        if (location < 0)
+            return;
+
         glProgramUniformMatrix4fv(m_Renderer2DID, location, 1, GL_FALSE, glm::value_ptr(value));
     }
 
     std::map<std::string, ShaderDataType> Shader::getActiveUniforms() {
+        ensureLinked();
+
         std::map<std::string, ShaderDataType> uniforms;
-        int count = 0;
-        glGetProgramiv(m_Renderer2DID, GL_ACTIVE_ATTRIBUTES, &count);
-
-        for (int i = 0; i < count; i++) {
-            GLchar name[256]; // name of the uniform
-            GLsizei length; // length of the name
-            GLint size; // size of the uniform
-            GLenum type; // type of the uniform
-            glGetActiveUniform(m_Renderer2DID, (GLuint)i, sizeof(name) - 1, &length, &size, &type, name);
-
-            std::string uniformName(name, length);
-            uniforms[uniformName] = ShaderDataTypeFromGLType(type);
-        }
+        for (const auto& [hash, info] : m_Uniforms)
+            uniforms[info.Name] = info.Type;
 
         return uniforms;
     }
 
     int Shader::getInt(const std::string& name) {
+        const int32_t location = getLocation(HashUniformName(name));
+        if (location < 0)
+            return {};
+
         int currentProgram = getCurrentActiveProgram();
         this->bind();
 
         int result;
-        glGetUniformiv(m_Renderer2DID, glGetUniformLocation(m_Renderer2DID, name.c_str()), &result);
+        glGetUniformiv(m_Renderer2DID, location, &result);
 
         // Bind back the previous program
         glUseProgram(currentProgram);
@@ -301,10 +560,14 @@ namespace Shado {
     }
 
     float Shader::getFloat(const std::string& name) {
+        const int32_t location = getLocation(HashUniformName(name));
+        if (location < 0)
+            return {};
+
         int currentProgram = getCurrentActiveProgram();
         this->bind();
         float result;
-        glGetUniformfv(m_Renderer2DID, glGetUniformLocation(m_Renderer2DID, name.c_str()), &result);
+        glGetUniformfv(m_Renderer2DID, location, &result);
 
         // Bind back the previous program
         glUseProgram(currentProgram);
@@ -312,10 +575,14 @@ namespace Shado {
     }
 
     glm::vec2 Shader::getFloat2(const std::string& name) {
+        const int32_t location = getLocation(HashUniformName(name));
+        if (location < 0)
+            return {};
+
         int currentProgram = getCurrentActiveProgram();
         this->bind();
         glm::vec2 result;
-        glGetnUniformfv(m_Renderer2DID, glGetUniformLocation(m_Renderer2DID, name.c_str()), sizeof(glm::vec2),
+        glGetnUniformfv(m_Renderer2DID, location, sizeof(glm::vec2),
                         glm::value_ptr(result));
         // Bind back the previous program
         glUseProgram(currentProgram);
@@ -323,10 +590,14 @@ namespace Shado {
     }
 
     glm::vec3 Shader::getFloat3(const std::string& name) {
+        const int32_t location = getLocation(HashUniformName(name));
+        if (location < 0)
+            return {};
+
         int currentProgram = getCurrentActiveProgram();
         this->bind();
         glm::vec3 result;
-        glGetnUniformfv(m_Renderer2DID, glGetUniformLocation(m_Renderer2DID, name.c_str()), sizeof(glm::vec3),
+        glGetnUniformfv(m_Renderer2DID, location, sizeof(glm::vec3),
                         glm::value_ptr(result));
         // Bind back the previous program
         glUseProgram(currentProgram);
@@ -334,10 +605,14 @@ namespace Shado {
     }
 
     glm::vec4 Shader::getFloat4(const std::string& name) {
+        const int32_t location = getLocation(HashUniformName(name));
+        if (location < 0)
+            return {};
+
         int currentProgram = getCurrentActiveProgram();
         this->bind();
         glm::vec4 result;
-        glGetnUniformfv(m_Renderer2DID, glGetUniformLocation(m_Renderer2DID, name.c_str()), sizeof(glm::vec4),
+        glGetnUniformfv(m_Renderer2DID, location, sizeof(glm::vec4),
                         glm::value_ptr(result));
         // Bind back the previous program
         glUseProgram(currentProgram);
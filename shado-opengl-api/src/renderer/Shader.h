@@ -3,6 +3,8 @@
 #include <unordered_map>
 #include <filesystem>
 #include <map>
+#include <string_view>
+#include <vector>
 
 #include "Buffer.h"
 #include "asset/Asset.h"
@@ -26,7 +28,32 @@ namespace Shado {
 
     class Shader : public Asset {
     public:
-        Shader(const std::string& fileContent);
+        /**
+         * Active uniform discovered when the program is linked. Uniforms that live in a
+         * uniform block have no location and are not part of the cache.
+         */
+        struct UniformInfo {
+            std::string Name;
+            int32_t Location = -1;
+            int32_t Count = 1;
+            ShaderDataType Type = ShaderDataType::None;
+        };
+
+        /** FNV-1a hash used to key the uniform cache. Hash constant names once and pass the hash around */
+        static constexpr uint32_t HashUniformName(std::string_view name) {
+            uint32_t hash = 2166136261u;
+            for (char c : name) {
+                hash ^= (uint8_t)c;
+                hash *= 16777619u;
+            }
+            return hash;
+        }
+
+        /**
+         * With async set the program link is only issued here. The shader is not ready until
+         * PollPendingCompilations sees the link finish; until then the renderer draws with its default shader
+         */
+        Shader(const std::string& fileContent, bool async = false);
         Shader(const std::string& name, const std::string& vertexSrc, const std::string& fragmentSrc);
         Shader(const Shader& other) = delete;
         virtual ~Shader();
@@ -35,6 +62,15 @@ namespace Shado {
         void unbind() const;
         void copyCustomUniformsTo(Ref<Shader>& target) const;
 
+        /** False while an async link is in flight or if it failed. Never blocks */
+        bool isReady() const;
+        /** True once an async compile or link failed. The program is gone and uniform calls do nothing */
+        bool hasFailed() const { return m_Failed; }
+        const std::string& getCompileError() const { return m_CompileError; }
+
+        /** Completes the async links the driver has finished. Called once per frame by the Application */
+        static void PollPendingCompilations();
+
         void setInt(const std::string& name, int value);
         void setIntArray(const std::string& name, int* values, uint32_t count);
         void setFloat(const std::string& name, float value);
@@ -44,6 +80,19 @@ namespace Shado {
         void setMat3(const std::string& name, const glm::mat3& value);
         void setMat4(const std::string& name, const glm::mat4& value);
 
+        void setInt(uint32_t nameHash, int value);
+        void setIntArray(uint32_t nameHash, int* values, uint32_t count);
+        void setFloat(uint32_t nameHash, float value);
+        void setFloat2(uint32_t nameHash, const glm::vec2& value);
+        void setFloat3(uint32_t nameHash, const glm::vec3& value);
+        void setFloat4(uint32_t nameHash, const glm::vec4& value);
+        void setMat3(uint32_t nameHash, const glm::mat3& value);
+        void setMat4(uint32_t nameHash, const glm::mat4& value);
+
+        /** Returns the cached uniform or nullptr if the program has no such (non block) uniform */
+        const UniformInfo* findUniform(uint32_t nameHash) const;
+        bool hasUniform(uint32_t nameHash) const { return findUniform(nameHash) != nullptr; }
+
         std::map<std::string, ShaderDataType> getActiveUniforms();
 
         int getInt(const std::string& name);
@@ -64,11 +113,29 @@ namespace Shado {
         std::string readFile(const std::filesystem::path& filepath);
         std::unordered_map<unsigned int, std::string> preProcess(const std::string& source);
         void compile(const std::unordered_map<unsigned int, std::string>& shaderSources);
+        void link(const std::unordered_map<unsigned int, std::string>& shaderSources);
+        void finishLink();
+        void resolvePending();
+        void ensureLinked();
+        bool loadCachedProgram(uint64_t cacheKey);
+        void reflect();
+        int32_t getLocation(uint32_t nameHash);
 
         static int getCurrentActiveProgram();
 
     private:
-        uint32_t m_Renderer2DID;
+        uint32_t m_Renderer2DID = 0;
+        uint64_t m_CacheKey = 0;
+
+        // Async compilation state, see PollPendingCompilations
+        std::vector<uint32_t> m_PendingShaderIDs;
+        bool m_Pending = false;
+        bool m_Failed = false;
+        std::string m_CompileError;
+        uint32_t m_PendingFrames = 0;
+
+        // Filled by reflect() after linking, so setting a uniform never queries the driver
+        std::unordered_map<uint32_t, UniformInfo> m_Uniforms;
 
         // Uniforms set by the editor. They are serialized and deserialized by the SceneSerializer
         std::unordered_map<std::string, std::tuple<ShaderDataType, void*>> m_CustomUniforms;
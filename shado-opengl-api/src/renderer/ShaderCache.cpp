@@ -0,0 +1,157 @@
+#include "ShaderCache.h"
+
+#include <GL/glew.h>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <mutex>
+#include <vector>
+
+#include "debug/Debug.h"
+#include "debug/Profile.h"
+#include "util/FileSystem.h"
+
+namespace Shado {
+    struct ShaderCacheHeader {
+        uint32_t Magic = 0x42535348; // "HSSB"
+        uint32_t Format = 0;
+        uint64_t Key = 0;
+        uint32_t Size = 0;
+        uint32_t Reserved = 0;
+    };
+
+    static std::filesystem::path s_Directory = "Cache/Shaders";
+    static std::mutex s_DirectoryMutex;
+
+    static uint64_t HashBytes(uint64_t hash, const void* data, size_t size) {
+        const uint8_t* bytes = (const uint8_t*)data;
+        for (size_t i = 0; i < size; i++) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+        return hash;
+    }
+
+    void ShaderCache::SetDirectory(const std::filesystem::path& directory) {
+        std::lock_guard<std::mutex> lock(s_DirectoryMutex);
+        s_Directory = directory;
+    }
+
+    const std::filesystem::path& ShaderCache::GetDirectory() {
+        return s_Directory;
+    }
+
+    uint64_t ShaderCache::GetKey(const std::string& source) {
+        // The driver strings are the same for the whole run
+        static const uint64_t s_DriverHash = [] {
+            uint64_t hash = 14695981039346656037ull;
+            for (GLenum name : {GL_VENDOR, GL_RENDERER, GL_VERSION}) {
+                const char* value = (const char*)glGetString(name);
+                if (value)
+                    hash = HashBytes(hash, value, strlen(value));
+            }
+            return hash;
+        }();
+
+        return HashBytes(s_DriverHash, source.data(), source.size());
+    }
+
+    bool ShaderCache::IsSupported() {
+        static const bool s_Supported = [] {
+            GLint formats = 0;
+            glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+            return formats > 0;
+        }();
+        return s_Supported;
+    }
+
+    std::filesystem::path ShaderCache::GetEntryPath(uint64_t key) {
+        std::lock_guard<std::mutex> lock(s_DirectoryMutex);
+        if (s_Directory.empty())
+            return {};
+        return s_Directory / std::format("{:016x}.bin", key);
+    }
+
+    void ShaderCache::PrepareProgram(uint32_t program) {
+        if (IsSupported())
+            glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+
+    bool ShaderCache::Load(uint64_t key, uint32_t program) {
+        SHADO_PROFILE_FUNCTION();
+
+        if (!IsSupported())
+            return false;
+
+        std::filesystem::path path = GetEntryPath(key);
+        if (path.empty() || !std::filesystem::exists(path))
+            return false;
+
+        Buffer file = FileSystem::ReadFileBinary(path);
+        if (file.Size < sizeof(ShaderCacheHeader)) {
+            file.Release();
+            return false;
+        }
+
+        ShaderCacheHeader header = file.Read<ShaderCacheHeader>();
+        if (header.Magic != ShaderCacheHeader().Magic || header.Key != key ||
+            header.Size != file.Size - sizeof(ShaderCacheHeader)) {
+            file.Release();
+            return false;
+        }
+
+        glProgramBinary(program, header.Format, file.As<uint8_t>() + sizeof(ShaderCacheHeader), header.Size);
+        file.Release();
+
+        GLint linked = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+        if (linked == GL_FALSE) {
+            // Driver changed in a way the version string does not show, drop the stale entry
+            SHADO_CORE_WARN("Cached program binary {} was rejected, compiling from source", path.string());
+            FileSystem::DeleteFile(path);
+            return false;
+        }
+
+        return true;
+    }
+
+    void ShaderCache::Store(uint64_t key, uint32_t program) {
+        SHADO_PROFILE_FUNCTION();
+
+        if (!IsSupported())
+            return;
+
+        std::filesystem::path path = GetEntryPath(key);
+        if (path.empty())
+            return;
+
+        GLint length = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+        if (length <= 0)
+            return;
+
+        ShaderCacheHeader header;
+        header.Key = key;
+        std::vector<uint8_t> binary(length);
+        GLsizei written = 0;
+        glGetProgramBinary(program, length, &written, &header.Format, binary.data());
+        header.Size = (uint32_t)written;
+
+        std::error_code error;
+        std::filesystem::create_directories(path.parent_path(), error);
+
+        // Write next to the entry and rename, so a crash or a concurrent reader never sees half a binary
+        std::filesystem::path temp = path;
+        temp += ".tmp";
+        {
+            std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+            if (!out) {
+                SHADO_CORE_WARN("Could not write program binary cache {}", temp.string());
+                return;
+            }
+            out.write((const char*)&header, sizeof(header));
+            out.write((const char*)binary.data(), written);
+        }
+        std::filesystem::rename(temp, path, error);
+    }
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+namespace Shado {
+    /**
+     * On-disk cache of linked program binaries. Entries are keyed by a hash of the shader source and of the
+     * driver vendor, renderer and version strings, so a driver update simply misses the cache
+     */
+    class ShaderCache {
+    public:
+        /** Directory where binaries are written. An empty path disables the cache */
+        static void SetDirectory(const std::filesystem::path& directory);
+        static const std::filesystem::path& GetDirectory();
+
+        static uint64_t GetKey(const std::string& source);
+
+        /**
+         * Links program from the cached binary. Returns false if there is no entry or the driver rejects it,
+         * in which case the caller compiles from source and calls Store()
+         */
+        static bool Load(uint64_t key, uint32_t program);
+        static void Store(uint64_t key, uint32_t program);
+
+        /** Must be set on a program before linking for its binary to be retrievable */
+        static void PrepareProgram(uint32_t program);
+
+    private:
+        static bool IsSupported();
+        static std::filesystem::path GetEntryPath(uint64_t key);
+    };
+}
@@ -0,0 +1,148 @@
+#include "SpriteAtlas.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "TextureStreamer.h"
+#include "stb_image.h"
+#include "debug/Profile.h"
+
+namespace Shado {
+    // Shelf packer: images sorted by decreasing height fill rows left to right, a new row opens
+    // below the tallest image of the last one and a new page when the page is full
+    struct AtlasShelfPacker {
+        uint32_t PageSize;
+        uint32_t X = 0, Y = 0, ShelfHeight = 0;
+
+        bool place(uint32_t width, uint32_t height, uint32_t& outX, uint32_t& outY) {
+            if (X + width > PageSize) {
+                X = 0;
+                Y += ShelfHeight;
+                ShelfHeight = 0;
+            }
+            if (Y + height > PageSize)
+                return false;
+
+            outX = X;
+            outY = Y;
+            X += width;
+            ShelfHeight = std::max(ShelfHeight, height);
+            return true;
+        }
+    };
+
+    SpriteAtlas::SpriteAtlas(const SpriteAtlasSpecification& specification)
+        : m_Specification(specification) {
+    }
+
+    void SpriteAtlas::build(const std::vector<std::pair<AssetHandle, std::filesystem::path>>& textures) {
+        SHADO_PROFILE_FUNCTION();
+
+        m_Pages.clear();
+        m_Regions.clear();
+        m_Decoded.clear();
+        m_RequestedCount = textures.size();
+        const uint32_t buildID = ++m_BuildID;
+
+        const uint32_t maxSize = std::min(m_Specification.MaxSpriteSize,
+                                          m_Specification.PageSize - 2 * m_Specification.Padding);
+
+        // Header reads are cheap, only the images that fit are decoded
+        std::vector<std::pair<AssetHandle, std::filesystem::path>> candidates;
+        for (const auto& [handle, path] : textures) {
+            int width, height, channels;
+            if (stbi_info(path.string().c_str(), &width, &height, &channels) &&
+                (uint32_t)width <= maxSize && (uint32_t)height <= maxSize)
+                candidates.emplace_back(handle, path);
+        }
+
+        m_PendingDecodes = (uint32_t)candidates.size();
+        if (candidates.empty()) {
+            pack();
+            return;
+        }
+
+        // The callbacks keep the atlas alive until the last decode lands
+        Ref<SpriteAtlas> self = this;
+        for (const auto& [handle, path] : candidates) {
+            TextureStreamer::Decode(path, [self, buildID, handle](ScopedRef<TextureCacheImage> image) {
+                if (buildID != self->m_BuildID)
+                    return;
+
+                if (image)
+                    self->m_Decoded.push_back({handle, std::move(image)});
+                if (--self->m_PendingDecodes == 0)
+                    self->pack();
+            });
+        }
+    }
+
+    void SpriteAtlas::pack() {
+        SHADO_PROFILE_FUNCTION();
+
+        const uint32_t pageSize = m_Specification.PageSize;
+        const uint32_t padding = m_Specification.Padding;
+
+        std::vector<DecodedImage>& images = m_Decoded;
+        std::sort(images.begin(), images.end(), [](const DecodedImage& a, const DecodedImage& b) {
+            return a.Image->Height != b.Image->Height ? a.Image->Height > b.Image->Height
+                                                      : a.Image->Width > b.Image->Width;
+        });
+
+        std::vector<std::vector<uint8_t>> pages;
+        AtlasShelfPacker packer{pageSize};
+        for (const DecodedImage& decoded : images) {
+            const TextureCacheImage& image = *decoded.Image;
+            const uint8_t* pixels = image.getMip(0);
+            const uint32_t cellWidth = image.Width + 2 * padding;
+            const uint32_t cellHeight = image.Height + 2 * padding;
+
+            uint32_t x, y;
+            if (pages.empty() || !packer.place(cellWidth, cellHeight, x, y)) {
+                pages.emplace_back((size_t)pageSize * pageSize * 4, 0);
+                packer = {pageSize};
+                packer.place(cellWidth, cellHeight, x, y);
+            }
+
+            // Copy the sprite into the middle of its cell, clamping the source coordinates extrudes the edges
+            uint8_t* page = pages.back().data();
+            for (uint32_t row = 0; row < cellHeight; row++) {
+                const int srcY = std::clamp((int)row - (int)padding, 0, (int)image.Height - 1);
+                uint8_t* dst = page + ((size_t)(y + row) * pageSize + x) * 4;
+                const uint8_t* src = pixels + (size_t)srcY * image.Width * 4;
+
+                for (uint32_t column = 0; column < padding; column++)
+                    std::memcpy(dst + column * 4, src, 4);
+                std::memcpy(dst + padding * 4, src, (size_t)image.Width * 4);
+                for (uint32_t column = 0; column < padding; column++)
+                    std::memcpy(dst + (padding + image.Width + column) * 4, src + (image.Width - 1) * 4, 4);
+            }
+
+            const float texel = 1.0f / (float)pageSize;
+            SpriteAtlasRegion& region = m_Regions[decoded.Handle];
+            region.Page = (uint32_t)pages.size() - 1;
+            region.UVRect = {
+                (x + padding) * texel, (y + padding) * texel,
+                (x + padding + image.Width) * texel, (y + padding + image.Height) * texel
+            };
+        }
+
+        m_Decoded.clear();
+
+        Texture2DSpecification spec;
+        spec.width = pageSize;
+        spec.height = pageSize;
+        spec.format = Texture2DChannelFormat::RGBA8;
+        spec.dataFormat = Texture2DDataFormat::RGBA;
+        for (const std::vector<uint8_t>& page : pages)
+            m_Pages.push_back(CreateRef<Texture2D>(spec, Buffer(page.data(), page.size())));
+
+        SHADO_CORE_INFO("Packed {} of {} textures into {} atlas pages", m_Regions.size(), m_RequestedCount,
+                        m_Pages.size());
+    }
+
+    const SpriteAtlasRegion* SpriteAtlas::findRegion(AssetHandle handle) const {
+        auto it = m_Regions.find(handle);
+        return it != m_Regions.end() ? &it->second : nullptr;
+    }
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <filesystem>
+#include <unordered_map>
+#include <vector>
+
+#include "Texture2D.h"
+#include "TextureCache.h"
+#include "asset/Asset.h"
+#include "glm/glm.hpp"
+
+namespace Shado {
+    struct SpriteAtlasSpecification {
+        uint32_t PageSize = 2048;
+        uint32_t MaxSpriteSize = 256; // Larger images keep their own texture
+        uint32_t Padding = 2; // Filled by extruding the sprite edges, so linear filtering never reads a neighbour
+    };
+
+    /**
+     * Where a packed texture asset lives. UVRect is min UV (xy) and max UV (zw) inside the page
+     */
+    struct SpriteAtlasRegion {
+        uint32_t Page = 0;
+        glm::vec4 UVRect = {0.0f, 0.0f, 1.0f, 1.0f};
+    };
+
+    /**
+     * Packs small texture assets into shared pages so sprites using them batch together.
+     * Built in the background when a project's asset registry is loaded
+     */
+    class SpriteAtlas : public RefCounted {
+    public:
+        SpriteAtlas(const SpriteAtlasSpecification& specification = {});
+
+        /**
+         * Decodes the images through the TextureCache on the TextureStreamer workers and returns right away.
+         * The pages are packed on the main thread once the last image is decoded, until then the atlas is
+         * empty and sprites keep their own textures. Images that are too big or fail to decode are left out
+         * @param textures Texture assets and their full file paths
+         */
+        void build(const std::vector<std::pair<AssetHandle, std::filesystem::path>>& textures);
+        bool isBuilding() const { return m_PendingDecodes > 0; }
+
+        /** @return The region of a packed texture, or nullptr if the asset is not in the atlas */
+        const SpriteAtlasRegion* findRegion(AssetHandle handle) const;
+        const Ref<Texture2D>& getPage(uint32_t page) const { return m_Pages[page]; }
+        uint32_t getPageCount() const { return (uint32_t)m_Pages.size(); }
+        uint32_t getRegionCount() const { return (uint32_t)m_Regions.size(); }
+
+        /** Maps a UV rect relative to a sprite into its page */
+        static glm::vec4 ComposeUVRect(const glm::vec4& regionRect, const glm::vec4& spriteRect) {
+            const glm::vec2 size = glm::vec2(regionRect.z, regionRect.w) - glm::vec2(regionRect.x, regionRect.y);
+            return {
+                regionRect.x + spriteRect.x * size.x, regionRect.y + spriteRect.y * size.y,
+                regionRect.x + spriteRect.z * size.x, regionRect.y + spriteRect.w * size.y
+            };
+        }
+
+    private:
+        void pack();
+
+    private:
+        struct DecodedImage {
+            AssetHandle Handle;
+            ScopedRef<TextureCacheImage> Image;
+        };
+
+        SpriteAtlasSpecification m_Specification;
+        std::vector<Ref<Texture2D>> m_Pages;
+        std::unordered_map<AssetHandle, SpriteAtlasRegion> m_Regions;
+
+        std::vector<DecodedImage> m_Decoded;
+        uint32_t m_PendingDecodes = 0;
+        uint32_t m_BuildID = 0; // Decodes of an older build are dropped
+        size_t m_RequestedCount = 0;
+    };
+}
@@ -2,6 +2,7 @@
 #include "debug/Profile.h"
 #include "GL/glew.h"
 #include <GLFW/glfw3.h>
+#include <algorithm>
 
 namespace Shado {
     Texture2D::Texture2D(uint32_t width, uint32_t height)
@@ -33,14 +34,15 @@ namespace Shado {
         m_DataFormat = (uint32_t)specs.dataFormat;
         m_Width = specs.width;
         m_Height = specs.height;
+        m_MipLevels = std::max(specs.mipLevels, 1u);
 
         glCreateTextures(GL_TEXTURE_2D, 1, &m_RendererID);
         SHADO_CORE_ASSERT(m_RendererID > 0 && m_RendererID < UINT32_MAX, "RendererId doesn't seem right!");
         SHADO_CORE_ASSERT(glIsTexture(m_RendererID) == GL_TRUE, "{} is NOT a texture!", m_RendererID);
         
-        glTextureStorage2D(m_RendererID, 1, m_InternalFormat, m_Width, m_Height);
+        glTextureStorage2D(m_RendererID, m_MipLevels, m_InternalFormat, m_Width, m_Height);
         
-        glTextureParameteri(m_RendererID, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTextureParameteri(m_RendererID, GL_TEXTURE_MIN_FILTER, m_MipLevels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
         glTextureParameteri(m_RendererID, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
         glTextureParameteri(m_RendererID, GL_TEXTURE_WRAP_S, GL_REPEAT);
@@ -58,11 +60,30 @@ namespace Shado {
     void Texture2D::setData(Buffer data) {
         SHADO_PROFILE_FUNCTION();
 
+        if (isCompressed()) {
+            setCompressedData(0, data);
+            return;
+        }
+
         uint32_t bpp = m_DataFormat == GL_RGBA ? 4 : 3;
         SHADO_CORE_ASSERT(data.Size == m_Width * m_Height * bpp, "Data must be entire texture!");
         glTextureSubImage2D(m_RendererID, 0, 0, 0, m_Width, m_Height, m_DataFormat, GL_UNSIGNED_BYTE, data.Data);
     }
 
+    void Texture2D::setCompressedData(uint32_t level, Buffer data) {
+        SHADO_PROFILE_FUNCTION();
+
+        SHADO_CORE_ASSERT(isCompressed(), "Texture is not block compressed!");
+        SHADO_CORE_ASSERT(level < m_MipLevels, "Mip level {} out of range", level);
+
+        const uint32_t width = std::max(m_Width >> level, 1u);
+        const uint32_t height = std::max(m_Height >> level, 1u);
+        SHADO_CORE_ASSERT(data.Size == GetCompressedImageSize((Texture2DChannelFormat)m_InternalFormat, width, height),
+                          "Data must be entire mip level!");
+        glCompressedTextureSubImage2D(m_RendererID, level, 0, 0, width, height, m_InternalFormat, (GLsizei)data.Size,
+                                      data.Data);
+    }
+
     void Texture2D::bind(uint32_t slot) const {
         glBindTextureUnit(slot, m_RendererID);
     }
@@ -12,9 +12,35 @@ namespace Shado {
     enum class Texture2DChannelFormat : uint32_t {
         RGBA8 = 0x8058,
         RGB8 = 0x8051,
-        RGBA16 = 0x805B
+        RGBA16 = 0x805B,
+
+        // Block compressed, 4x4 texel blocks
+        BC1 = 0x83F1, // RGB + 1 bit alpha, 8 bytes per block
+        BC3 = 0x83F3, // RGBA, 16 bytes per block
+        BC4 = 0x8DBB, // R, 8 bytes per block
+        BC5 = 0x8DBD, // RG, 16 bytes per block
+        BC7 = 0x8E8C  // RGBA, 16 bytes per block
     };
 
+    inline bool IsCompressedFormat(Texture2DChannelFormat format) {
+        switch (format) {
+        case Texture2DChannelFormat::BC1:
+        case Texture2DChannelFormat::BC3:
+        case Texture2DChannelFormat::BC4:
+        case Texture2DChannelFormat::BC5:
+        case Texture2DChannelFormat::BC7:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    /** Size in bytes of one mip level of a block compressed format */
+    inline uint32_t GetCompressedImageSize(Texture2DChannelFormat format, uint32_t width, uint32_t height) {
+        const uint32_t blockSize = format == Texture2DChannelFormat::BC1 || format == Texture2DChannelFormat::BC4 ? 8 : 16;
+        return ((width + 3) / 4) * ((height + 3) / 4) * blockSize;
+    }
+
     enum class Texture2DDataFormat : uint32_t {
         RGB = 0x1907,
         RGBA = 0x1908
@@ -25,6 +51,7 @@ namespace Shado {
         Texture2DChannelFormat format = Texture2DChannelFormat::RGBA8;
         Texture2DDataFormat dataFormat = Texture2DDataFormat::RGBA;
         bool generateMips = true;
+        uint32_t mipLevels = 1; // Storage levels, filled by the uploader
 
         /* Optional but useful for debugging */
         std::filesystem::path path;
@@ -40,10 +67,13 @@ namespace Shado {
         ~Texture2D();
 
         void setData(Buffer data);
+        /** Uploads one mip level of a block compressed texture. data must hold the whole level */
+        void setCompressedData(uint32_t level, Buffer data);
 
         void bind(uint32_t slot = 0) const;
         void unbind() const;
 
+        /** False while the TextureStreamer is still uploading the pixels */
         bool isLoaded() const { return m_IsLoaded; }
 
         int getWidth() const { return m_Width; }
@@ -51,6 +81,8 @@ namespace Shado {
         uint32_t getRendererID() const { return m_RendererID; }
         int getDataFormat() const { return m_DataFormat; }
         int getInternalFormat() const { return m_InternalFormat; }
+        uint32_t getMipLevels() const { return m_MipLevels; }
+        bool isCompressed() const { return IsCompressedFormat((Texture2DChannelFormat)m_InternalFormat); }
 
         bool operator==(const Texture2D& other) const;
 
@@ -63,8 +95,9 @@ namespace Shado {
 
         unsigned int m_InternalFormat;
         unsigned int m_DataFormat;
+        uint32_t m_MipLevels = 1;
 
-        bool m_IsLoaded = false;
+        bool m_IsLoaded = true;
 
         // Cache texture
         struct TextureInfo {
@@ -73,5 +106,7 @@ namespace Shado {
         };
 
         inline static std::unordered_map<std::string, TextureInfo> s_cache;
+
+        friend class TextureStreamer;
     };
 }
@@ -0,0 +1,222 @@
+#include "TextureCache.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+#include "stb_image.h"
+#include "debug/Debug.h"
+#include "debug/Profile.h"
+
+#if defined(_M_X64) || defined(__SSE2__)
+    #include <emmintrin.h>
+    #define SHADO_TEXTURE_CACHE_SSE2 1
+#endif
+
+namespace Shado {
+    struct TextureCacheHeader {
+        uint32_t Magic = 0x58455453; // "STEX"
+        uint32_t Version = 1;
+        uint64_t Key = 0;
+        uint32_t Width = 0, Height = 0;
+        uint32_t MipCount = 0;
+        uint32_t Reserved = 0;
+        std::array<uint64_t, TextureCacheImage::MaxMips> MipOffsets = {}; // From the start of the file
+    };
+
+    static std::filesystem::path s_Directory = "Cache/Textures";
+    static std::mutex s_DirectoryMutex;
+
+    // Word at a time so hashing a large file is bound by the read, not the hash
+    static uint64_t HashContents(const uint8_t* data, size_t size) {
+        uint64_t hash = 14695981039346656037ull ^ size;
+        size_t i = 0;
+        for (; i + 8 <= size; i += 8) {
+            uint64_t word;
+            std::memcpy(&word, data + i, 8);
+            hash = (hash ^ word) * 0x100000001B3ull;
+            hash ^= hash >> 29;
+        }
+        for (; i < size; i++)
+            hash = (hash ^ data[i]) * 0x100000001B3ull;
+        return hash;
+    }
+
+    void TextureCache::SetDirectory(const std::filesystem::path& directory) {
+        std::lock_guard<std::mutex> lock(s_DirectoryMutex);
+        s_Directory = directory;
+    }
+
+    uint32_t TextureCache::GetMipCount(uint32_t width, uint32_t height) {
+        return std::min((uint32_t)std::bit_width(std::max(width, height)), TextureCacheImage::MaxMips);
+    }
+
+    void TextureCache::Downsample(const uint8_t* src, uint32_t width, uint32_t height, uint8_t* dst) {
+        const uint32_t dstWidth = std::max(width / 2, 1u);
+        const uint32_t dstHeight = std::max(height / 2, 1u);
+
+        for (uint32_t y = 0; y < dstHeight; y++) {
+            const uint8_t* row0 = src + (size_t)std::min(y * 2, height - 1) * width * 4;
+            const uint8_t* row1 = src + (size_t)std::min(y * 2 + 1, height - 1) * width * 4;
+            uint8_t* out = dst + (size_t)y * dstWidth * 4;
+
+            uint32_t x = 0;
+#if SHADO_TEXTURE_CACHE_SSE2
+            // 4 output texels per step. The channels are summed in 16 bits so the result is (sum + 2) / 4,
+            // exactly like the scalar tail, instead of rounding up twice with chained byte averages
+            if (width >= 2) {
+                const __m128i zero = _mm_setzero_si128();
+                const __m128i two = _mm_set1_epi16(2);
+                for (; x + 4 <= dstWidth && (x + 4) * 2 <= width; x += 4) {
+                    __m128 a0 = _mm_loadu_ps((const float*)(row0 + x * 8));
+                    __m128 a1 = _mm_loadu_ps((const float*)(row0 + x * 8 + 16));
+                    __m128 b0 = _mm_loadu_ps((const float*)(row1 + x * 8));
+                    __m128 b1 = _mm_loadu_ps((const float*)(row1 + x * 8 + 16));
+
+                    __m128i aEven = _mm_castps_si128(_mm_shuffle_ps(a0, a1, _MM_SHUFFLE(2, 0, 2, 0)));
+                    __m128i aOdd = _mm_castps_si128(_mm_shuffle_ps(a0, a1, _MM_SHUFFLE(3, 1, 3, 1)));
+                    __m128i bEven = _mm_castps_si128(_mm_shuffle_ps(b0, b1, _MM_SHUFFLE(2, 0, 2, 0)));
+                    __m128i bOdd = _mm_castps_si128(_mm_shuffle_ps(b0, b1, _MM_SHUFFLE(3, 1, 3, 1)));
+
+                    __m128i lo = _mm_add_epi16(
+                        _mm_add_epi16(_mm_unpacklo_epi8(aEven, zero), _mm_unpacklo_epi8(aOdd, zero)),
+                        _mm_add_epi16(_mm_unpacklo_epi8(bEven, zero), _mm_unpacklo_epi8(bOdd, zero)));
+                    __m128i hi = _mm_add_epi16(
+                        _mm_add_epi16(_mm_unpackhi_epi8(aEven, zero), _mm_unpackhi_epi8(aOdd, zero)),
+                        _mm_add_epi16(_mm_unpackhi_epi8(bEven, zero), _mm_unpackhi_epi8(bOdd, zero)));
+                    lo = _mm_srli_epi16(_mm_add_epi16(lo, two), 2);
+                    hi = _mm_srli_epi16(_mm_add_epi16(hi, two), 2);
+                    _mm_storeu_si128((__m128i*)(out + x * 4), _mm_packus_epi16(lo, hi));
+                }
+            }
+#endif
+            for (; x < dstWidth; x++) {
+                const uint32_t x0 = std::min(x * 2, width - 1);
+                const uint32_t x1 = std::min(x * 2 + 1, width - 1);
+                for (uint32_t c = 0; c < 4; c++) {
+                    const uint32_t sum = row0[x0 * 4 + c] + row0[x1 * 4 + c] + row1[x0 * 4 + c] + row1[x1 * 4 + c];
+                    out[x * 4 + c] = (uint8_t)((sum + 2) / 4);
+                }
+            }
+        }
+    }
+
+    static std::filesystem::path GetEntryPath(uint64_t key) {
+        std::lock_guard<std::mutex> lock(s_DirectoryMutex);
+        if (s_Directory.empty())
+            return {};
+        return s_Directory / std::format("{:016x}.stex", key);
+    }
+
+    static ScopedRef<TextureCacheImage> MapEntry(const std::filesystem::path& path, uint64_t key) {
+        if (path.empty() || !std::filesystem::exists(path))
+            return nullptr;
+
+        auto file = CreateScoped<MappedFile>(path);
+        if (!file->isValid() || file->getSize() < sizeof(TextureCacheHeader))
+            return nullptr;
+
+        TextureCacheHeader header;
+        std::memcpy(&header, file->getData(), sizeof(header));
+        if (header.Magic != TextureCacheHeader().Magic || header.Version != TextureCacheHeader().Version ||
+            header.Key != key || header.MipCount == 0 || header.MipCount > TextureCacheImage::MaxMips)
+            return nullptr;
+
+        // The last mip must end inside the file, otherwise the entry was truncated
+        const uint32_t last = header.MipCount - 1;
+        const uint64_t lastSize = (uint64_t)std::max(header.Width >> last, 1u) * std::max(header.Height >> last, 1u) * 4;
+        if (header.MipOffsets[last] + lastSize > file->getSize())
+            return nullptr;
+
+        auto image = CreateScoped<TextureCacheImage>();
+        image->Width = header.Width;
+        image->Height = header.Height;
+        image->MipCount = header.MipCount;
+        image->MipOffsets = header.MipOffsets;
+        image->Data = file->getData();
+        image->File = std::move(file);
+        return image;
+    }
+
+    static void WriteEntry(const std::filesystem::path& path, uint64_t key, const TextureCacheImage& image) {
+        if (path.empty())
+            return;
+
+        TextureCacheHeader header;
+        header.Key = key;
+        header.Width = image.Width;
+        header.Height = image.Height;
+        header.MipCount = image.MipCount;
+        for (uint32_t i = 0; i < image.MipCount; i++)
+            header.MipOffsets[i] = sizeof(TextureCacheHeader) + image.MipOffsets[i];
+
+        std::error_code error;
+        std::filesystem::create_directories(path.parent_path(), error);
+
+        // Renamed into place so a concurrent reader never maps half an entry
+        std::filesystem::path temp = path;
+        temp += std::format(".{}.tmp", std::hash<std::thread::id>()(std::this_thread::get_id()));
+        {
+            std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+            if (!out) {
+                SHADO_CORE_WARN("Could not write texture cache entry {}", temp.string());
+                return;
+            }
+            out.write((const char*)&header, sizeof(header));
+            out.write((const char*)image.Owned.data(), image.Owned.size());
+        }
+        std::filesystem::rename(temp, path, error);
+    }
+
+    ScopedRef<TextureCacheImage> TextureCache::Acquire(const std::filesystem::path& source) {
+        SHADO_PROFILE_FUNCTION();
+
+        // The source has to be read for its hash anyway, on a miss it is decoded from the same memory
+        MappedFile sourceFile(source);
+        if (!sourceFile.isValid())
+            return nullptr;
+
+        const uint64_t key = HashContents(sourceFile.getData(), sourceFile.getSize());
+        const std::filesystem::path entryPath = GetEntryPath(key);
+        if (auto image = MapEntry(entryPath, key))
+            return image;
+
+        int width, height, channels;
+        stbi_set_flip_vertically_on_load_thread(1); // Same orientation as the TextureImporter
+        stbi_uc* pixels = stbi_load_from_memory(sourceFile.getData(), (int)sourceFile.getSize(),
+                                                &width, &height, &channels, 4);
+        if (!pixels)
+            return nullptr;
+
+        auto image = CreateScoped<TextureCacheImage>();
+        image->Width = width;
+        image->Height = height;
+        image->MipCount = GetMipCount(width, height);
+
+        uint64_t size = 0;
+        for (uint32_t level = 0; level < image->MipCount; level++) {
+            image->MipOffsets[level] = size;
+            size += (uint64_t)image->getMipWidth(level) * image->getMipHeight(level) * 4;
+        }
+
+        image->Owned.resize(size);
+        std::memcpy(image->Owned.data(), pixels, (size_t)width * height * 4);
+        stbi_image_free(pixels);
+
+        {
+            SHADO_PROFILE_SCOPE("TextureCache::Acquire - mips");
+            for (uint32_t level = 1; level < image->MipCount; level++) {
+                Downsample(image->Owned.data() + image->MipOffsets[level - 1], image->getMipWidth(level - 1),
+                           image->getMipHeight(level - 1), image->Owned.data() + image->MipOffsets[level]);
+            }
+        }
+        image->Data = image->Owned.data();
+
+        WriteEntry(entryPath, key, *image);
+        return image;
+    }
+}
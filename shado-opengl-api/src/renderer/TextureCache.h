@@ -0,0 +1,50 @@
+#pragma once
+#include <array>
+#include <filesystem>
+#include <vector>
+
+#include "util/FileSystem.h"
+#include "util/Memory.h"
+
+namespace Shado {
+    /**
+     * Decoded RGBA8 image with its whole mip chain, either mapped from the texture cache or freshly built
+     */
+    struct TextureCacheImage {
+        static constexpr uint32_t MaxMips = 16;
+
+        uint32_t Width = 0, Height = 0;
+        uint32_t MipCount = 0;
+        std::array<uint64_t, MaxMips> MipOffsets = {}; // Into Data
+
+        const uint8_t* Data = nullptr;
+        ScopedRef<MappedFile> File; // Set when Data points into the cache file
+        std::vector<uint8_t> Owned; // Set when the image was decoded
+
+        const uint8_t* getMip(uint32_t level) const { return Data + MipOffsets[level]; }
+        uint32_t getMipWidth(uint32_t level) const { return std::max(Width >> level, 1u); }
+        uint32_t getMipHeight(uint32_t level) const { return std::max(Height >> level, 1u); }
+    };
+
+    /**
+     * Import cache of decoded textures. Entries are keyed by a hash of the source file contents and hold the
+     * RGBA8 texels of every mip level, so a warm load is a memory mapping instead of a decode
+     */
+    class TextureCache {
+    public:
+        /** Directory where entries are written. An empty path disables the cache */
+        static void SetDirectory(const std::filesystem::path& directory);
+
+        /**
+         * Maps the cached entry of an image, or decodes it, builds its mips and writes the entry.
+         * Safe to call from worker threads
+         * @return nullptr if the image cannot be read
+         */
+        static ScopedRef<TextureCacheImage> Acquire(const std::filesystem::path& source);
+
+        /** 2x2 box filter of an RGBA8 image. Odd edges are clamped */
+        static void Downsample(const uint8_t* src, uint32_t width, uint32_t height, uint8_t* dst);
+
+        static uint32_t GetMipCount(uint32_t width, uint32_t height);
+    };
+}
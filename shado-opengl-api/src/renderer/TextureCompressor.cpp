@@ -0,0 +1,209 @@
+#include "TextureCompressor.h"
+
+#include <algorithm>
+#include <cstring>
+#include <future>
+#include <thread>
+
+#include "debug/Profile.h"
+
+namespace Shado {
+    struct Block {
+        uint8_t Texels[16][4];
+    };
+
+    static void FetchBlock(const uint8_t* rgba, uint32_t width, uint32_t height, uint32_t bx, uint32_t by, Block& block) {
+        for (uint32_t y = 0; y < 4; y++) {
+            const uint32_t sy = std::min(by * 4 + y, height - 1);
+            for (uint32_t x = 0; x < 4; x++) {
+                const uint32_t sx = std::min(bx * 4 + x, width - 1);
+                std::memcpy(block.Texels[y * 4 + x], rgba + ((size_t)sy * width + sx) * 4, 4);
+            }
+        }
+    }
+
+    static uint16_t To565(const int color[3]) {
+        return (uint16_t)(((color[0] * 31 + 127) / 255) << 11 | ((color[1] * 63 + 127) / 255) << 5 |
+                          ((color[2] * 31 + 127) / 255));
+    }
+
+    static void From565(uint16_t packed, int color[3]) {
+        const int r = (packed >> 11) & 31, g = (packed >> 5) & 63, b = packed & 31;
+        color[0] = (r << 3) | (r >> 2);
+        color[1] = (g << 2) | (g >> 4);
+        color[2] = (b << 3) | (b >> 2);
+    }
+
+    /** 8 byte color block. punchThrough uses the 3 color mode with index 3 as transparent black */
+    static void EncodeColor(const Block& block, bool punchThrough, uint8_t* out) {
+        int min[3] = {255, 255, 255}, max[3] = {0, 0, 0};
+        bool transparent[16] = {};
+        for (uint32_t i = 0; i < 16; i++) {
+            transparent[i] = punchThrough && block.Texels[i][3] < 128;
+            if (transparent[i])
+                continue;
+            for (uint32_t c = 0; c < 3; c++) {
+                min[c] = std::min<int>(min[c], block.Texels[i][c]);
+                max[c] = std::max<int>(max[c], block.Texels[i][c]);
+            }
+        }
+        if (min[0] > max[0]) // Fully transparent
+            min[0] = min[1] = min[2] = max[0] = max[1] = max[2] = 0;
+
+        // Pick the bounding box diagonal that follows the colors, then inset it to cut the quantization error
+        int covGB = 0, covRB = 0;
+        for (uint32_t i = 0; i < 16; i++) {
+            if (transparent[i])
+                continue;
+            const int r = block.Texels[i][0] - (min[0] + max[0]) / 2;
+            const int g = block.Texels[i][1] - (min[1] + max[1]) / 2;
+            const int b = block.Texels[i][2] - (min[2] + max[2]) / 2;
+            covGB += g * b;
+            covRB += r * b;
+        }
+        if (covRB < 0)
+            std::swap(min[0], max[0]);
+        if (covGB < 0)
+            std::swap(min[1], max[1]);
+
+        for (uint32_t c = 0; c < 3; c++) {
+            const int inset = (max[c] - min[c]) / 16;
+            max[c] = std::clamp(max[c] - inset, 0, 255);
+            min[c] = std::clamp(min[c] + inset, 0, 255);
+        }
+
+        uint16_t c0 = To565(max), c1 = To565(min);
+        // 4 color mode needs c0 > c1, 3 color mode c0 <= c1
+        if (punchThrough ? c0 > c1 : c0 < c1)
+            std::swap(c0, c1);
+
+        int palette[4][3];
+        From565(c0, palette[0]);
+        From565(c1, palette[1]);
+        const bool fourColors = c0 > c1;
+        for (uint32_t c = 0; c < 3; c++) {
+            if (fourColors) {
+                palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+                palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+            }
+            else {
+                palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+                palette[3][c] = 0;
+            }
+        }
+
+        uint32_t indices = 0;
+        for (uint32_t i = 0; i < 16; i++) {
+            uint32_t best = 3;
+            if (!transparent[i]) {
+                int bestError = INT32_MAX;
+                for (uint32_t p = 0; p < (fourColors ? 4u : 3u); p++) {
+                    int error = 0;
+                    for (uint32_t c = 0; c < 3; c++) {
+                        const int d = block.Texels[i][c] - palette[p][c];
+                        error += d * d;
+                    }
+                    if (error < bestError) {
+                        bestError = error;
+                        best = p;
+                    }
+                }
+            }
+            indices |= best << (i * 2);
+        }
+
+        std::memcpy(out, &c0, 2);
+        std::memcpy(out + 2, &c1, 2);
+        std::memcpy(out + 4, &indices, 4);
+    }
+
+    /** 8 byte BC4 block of one channel, also the alpha half of BC3 */
+    static void EncodeChannel(const Block& block, uint32_t channel, uint8_t* out) {
+        int min = 255, max = 0;
+        for (uint32_t i = 0; i < 16; i++) {
+            min = std::min<int>(min, block.Texels[i][channel]);
+            max = std::max<int>(max, block.Texels[i][channel]);
+        }
+
+        // a0 > a1 selects the 8 value mode: codes 0 and 1 are the endpoints, 2-7 step from a0 to a1
+        uint64_t bits = (uint64_t)max | (uint64_t)min << 8;
+        if (max > min) {
+            for (uint32_t i = 0; i < 16; i++) {
+                const int step = ((max - block.Texels[i][channel]) * 7 + (max - min) / 2) / (max - min);
+                const uint64_t code = step == 0 ? 0 : step == 7 ? 1 : step + 1;
+                bits |= code << (16 + i * 3);
+            }
+        }
+        std::memcpy(out, &bits, 8);
+    }
+
+    bool TextureCompressor::CanEncode(Texture2DChannelFormat format) {
+        return format == Texture2DChannelFormat::BC1 || format == Texture2DChannelFormat::BC3 ||
+            format == Texture2DChannelFormat::BC4 || format == Texture2DChannelFormat::BC5;
+    }
+
+    Texture2DChannelFormat TextureCompressor::ChooseFormat(const uint8_t* rgba, uint32_t width, uint32_t height) {
+        const size_t texels = (size_t)width * height;
+        for (size_t i = 0; i < texels; i++) {
+            const uint8_t alpha = rgba[i * 4 + 3];
+            if (alpha != 0 && alpha != 255)
+                return Texture2DChannelFormat::BC3;
+        }
+        return Texture2DChannelFormat::BC1;
+    }
+
+    std::vector<uint8_t> TextureCompressor::Compress(const uint8_t* rgba, uint32_t width, uint32_t height,
+                                                     Texture2DChannelFormat format) {
+        SHADO_PROFILE_FUNCTION();
+        SHADO_CORE_ASSERT(CanEncode(format), "Texture format {} cannot be encoded", (uint32_t)format);
+
+        const uint32_t blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+        const uint32_t blockBytes = format == Texture2DChannelFormat::BC1 || format == Texture2DChannelFormat::BC4 ? 8 : 16;
+        std::vector<uint8_t> result((size_t)blocksX * blocksY * blockBytes);
+
+        bool punchThrough = false;
+        if (format == Texture2DChannelFormat::BC1) {
+            for (size_t i = 0; i < (size_t)width * height && !punchThrough; i++)
+                punchThrough = rgba[i * 4 + 3] < 128;
+        }
+
+        auto encodeRows = [&](uint32_t firstRow, uint32_t lastRow) {
+            Block block;
+            for (uint32_t by = firstRow; by < lastRow; by++) {
+                for (uint32_t bx = 0; bx < blocksX; bx++) {
+                    FetchBlock(rgba, width, height, bx, by, block);
+                    uint8_t* out = result.data() + ((size_t)by * blocksX + bx) * blockBytes;
+                    switch (format) {
+                    case Texture2DChannelFormat::BC1:
+                        EncodeColor(block, punchThrough, out);
+                        break;
+                    case Texture2DChannelFormat::BC3:
+                        EncodeChannel(block, 3, out);
+                        EncodeColor(block, false, out + 8);
+                        break;
+                    case Texture2DChannelFormat::BC4:
+                        EncodeChannel(block, 0, out);
+                        break;
+                    case Texture2DChannelFormat::BC5:
+                        EncodeChannel(block, 0, out);
+                        EncodeChannel(block, 1, out + 8);
+                        break;
+                    default:
+                        break;
+                    }
+                }
+            }
+        };
+
+        // Block rows are independent, split them across the cores
+        const uint32_t taskCount = std::clamp(std::thread::hardware_concurrency(), 1u, blocksY);
+        const uint32_t rowsPerTask = (blocksY + taskCount - 1) / taskCount;
+        std::vector<std::future<void>> tasks;
+        for (uint32_t row = 0; row < blocksY; row += rowsPerTask)
+            tasks.push_back(std::async(std::launch::async, encodeRows, row, std::min(row + rowsPerTask, blocksY)));
+        for (auto& task : tasks)
+            task.wait();
+
+        return result;
+    }
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include <vector>
+
+#include "Texture2D.h"
+
+namespace Shado {
+    /**
+     * Offline block compression of RGBA8 images. Uses a bounding box endpoint fit, which is fast enough to run
+     * at import and close to what the GPU vendors' fast modes produce
+     */
+    class TextureCompressor {
+    public:
+        /** BC7 can be loaded from KTX2 files but is not encoded here */
+        static bool CanEncode(Texture2DChannelFormat format);
+
+        /** BC1 when alpha is only ever fully opaque or fully transparent, BC3 otherwise */
+        static Texture2DChannelFormat ChooseFormat(const uint8_t* rgba, uint32_t width, uint32_t height);
+
+        /** Compresses one level of tightly packed RGBA8 texels. Partial edge blocks repeat the last row and column */
+        static std::vector<uint8_t> Compress(const uint8_t* rgba, uint32_t width, uint32_t height,
+                                             Texture2DChannelFormat format);
+    };
+}
@@ -0,0 +1,262 @@
+#include "TextureStreamer.h"
+
+#include <GL/glew.h>
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "Buffer.h"
+#include "TextureCache.h"
+#include "stb_image.h"
+#include "debug/Profile.h"
+
+namespace Shado {
+    struct DecodeJob {
+        uint64_t ID;
+        std::filesystem::path Path;
+    };
+
+    struct DecodedImage {
+        uint64_t ID;
+        ScopedRef<TextureCacheImage> Image; // Null if decoding failed
+    };
+
+    struct PendingUpload {
+        Ref<Texture2D> Texture;
+        ScopedRef<TextureCacheImage> Image;
+        uint32_t Mip = 0;
+        uint32_t UploadedRows = 0; // Of the current mip
+    };
+
+    // Workers only ever see paths and pixels. Texture refs stay on the main thread, so a texture
+    // is never released (and its GL object never deleted) off the context thread
+    struct TextureStreamerData {
+        std::vector<std::thread> Workers;
+        std::mutex Mutex;
+        std::condition_variable WorkAvailable;
+        std::deque<DecodeJob> Jobs;
+        std::vector<DecodedImage> Decoded;
+        bool Running = false;
+
+        std::unordered_map<uint64_t, Ref<Texture2D>> Decoding;
+        std::unordered_map<uint64_t, std::function<void(ScopedRef<TextureCacheImage>)>> DecodeCallbacks;
+        std::deque<PendingUpload> Uploads;
+        uint64_t NextID = 1;
+        uint64_t UploadBudget = TextureStreamer::DefaultUploadBudget;
+        ScopedRef<StreamingBuffer> PixelBuffer;
+    };
+
+    static TextureStreamerData s_Streamer;
+
+    static void DecodeWorker() {
+        while (true) {
+            DecodeJob job;
+            {
+                std::unique_lock<std::mutex> lock(s_Streamer.Mutex);
+                s_Streamer.WorkAvailable.wait(lock, [] { return !s_Streamer.Running || !s_Streamer.Jobs.empty(); });
+                if (!s_Streamer.Running)
+                    return;
+
+                job = std::move(s_Streamer.Jobs.front());
+                s_Streamer.Jobs.pop_front();
+            }
+
+            // Hashing, decoding and building the mips all happen here, a cache hit is only a mapping
+            ScopedRef<TextureCacheImage> image = TextureCache::Acquire(job.Path);
+            if (!image)
+                SHADO_CORE_ERROR("TextureStreamer - could not decode {}", job.Path.string());
+
+            std::lock_guard<std::mutex> lock(s_Streamer.Mutex);
+            s_Streamer.Decoded.push_back({job.ID, std::move(image)});
+        }
+    }
+
+    static void StartWorkers() {
+        if (s_Streamer.Running)
+            return;
+
+        s_Streamer.Running = true;
+        uint32_t workerCount = std::clamp(std::thread::hardware_concurrency() / 2, 1u, 4u);
+        for (uint32_t i = 0; i < workerCount; i++)
+            s_Streamer.Workers.emplace_back(DecodeWorker);
+    }
+
+    Ref<Texture2D> TextureStreamer::Load(const std::filesystem::path& path) {
+        SHADO_PROFILE_FUNCTION();
+
+        int width, height, channels;
+        std::string pathStr = path.string();
+        if (!stbi_info(pathStr.c_str(), &width, &height, &channels)) {
+            SHADO_CORE_ERROR("TextureStreamer - could not read image header {}", pathStr);
+            return nullptr;
+        }
+
+        // The texture cache always stores RGBA8 with a full mip chain
+        Texture2DSpecification spec;
+        spec.width = width;
+        spec.height = height;
+        spec.path = path;
+        spec.format = Texture2DChannelFormat::RGBA8;
+        spec.dataFormat = Texture2DDataFormat::RGBA;
+        spec.mipLevels = TextureCache::GetMipCount(width, height);
+
+        Ref<Texture2D> texture = CreateRef<Texture2D>(spec);
+        texture->m_IsLoaded = false;
+
+        const uint64_t id = s_Streamer.NextID++;
+        s_Streamer.Decoding[id] = texture;
+
+        StartWorkers();
+        {
+            std::lock_guard<std::mutex> lock(s_Streamer.Mutex);
+            s_Streamer.Jobs.push_back({id, path});
+        }
+        s_Streamer.WorkAvailable.notify_one();
+        return texture;
+    }
+
+    void TextureStreamer::Decode(const std::filesystem::path& path,
+                                 std::function<void(ScopedRef<TextureCacheImage> image)> done) {
+        const uint64_t id = s_Streamer.NextID++;
+        s_Streamer.DecodeCallbacks[id] = std::move(done);
+
+        StartWorkers();
+        {
+            std::lock_guard<std::mutex> lock(s_Streamer.Mutex);
+            s_Streamer.Jobs.push_back({id, path});
+        }
+        s_Streamer.WorkAvailable.notify_one();
+    }
+
+    void TextureStreamer::Update() {
+        SHADO_PROFILE_FUNCTION();
+
+        std::vector<DecodedImage> decoded;
+        {
+            std::lock_guard<std::mutex> lock(s_Streamer.Mutex);
+            decoded.swap(s_Streamer.Decoded);
+        }
+
+        for (DecodedImage& image : decoded) {
+            auto callback = s_Streamer.DecodeCallbacks.find(image.ID);
+            if (callback != s_Streamer.DecodeCallbacks.end()) {
+                auto done = std::move(callback->second);
+                s_Streamer.DecodeCallbacks.erase(callback);
+                done(std::move(image.Image));
+                continue;
+            }
+
+            auto it = s_Streamer.Decoding.find(image.ID);
+            Ref<Texture2D> texture = it->second;
+            s_Streamer.Decoding.erase(it);
+
+            // Failed images stay white, dropped textures are not worth uploading
+            if (!image.Image || texture->GetRefCount() == 1)
+                continue;
+
+            // The file changed between reading its header and decoding it
+            if (image.Image->Width != (uint32_t)texture->getWidth() || image.Image->Height != (uint32_t)texture->getHeight() ||
+                image.Image->MipCount != texture->getMipLevels()) {
+                SHADO_CORE_WARN("TextureStreamer - image changed size while loading, keeping the white texture");
+                continue;
+            }
+            s_Streamer.Uploads.push_back({texture, std::move(image.Image)});
+        }
+
+        if (s_Streamer.Uploads.empty())
+            return;
+
+        if (!s_Streamer.PixelBuffer)
+            s_Streamer.PixelBuffer = CreateScoped<StreamingBuffer>((uint32_t)s_Streamer.UploadBudget, 2, 4);
+
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, s_Streamer.PixelBuffer->getRendererID());
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+        uint64_t budget = s_Streamer.UploadBudget;
+        while (!s_Streamer.Uploads.empty() && budget > 0) {
+            PendingUpload& upload = s_Streamer.Uploads.front();
+            Texture2D& texture = *upload.Texture;
+            const TextureCacheImage& image = *upload.Image;
+
+            const uint32_t mipWidth = image.getMipWidth(upload.Mip);
+            const uint32_t mipHeight = image.getMipHeight(upload.Mip);
+            const uint8_t* pixels = image.getMip(upload.Mip);
+
+            const uint32_t rowSize = mipWidth * 4;
+            const uint32_t remainingRows = mipHeight - upload.UploadedRows;
+
+            // Big textures are split into bands of rows across frames, but every frame moves at least one row
+            const uint32_t rows = (uint32_t)std::min<uint64_t>(remainingRows, std::max<uint64_t>(budget / rowSize, 1));
+            const uint32_t size = rows * rowSize;
+
+            if (size <= s_Streamer.UploadBudget) {
+                void* dst = s_Streamer.PixelBuffer->map(size);
+                std::memcpy(dst, pixels + (size_t)upload.UploadedRows * rowSize, size);
+                uint32_t offset = s_Streamer.PixelBuffer->commit(size);
+                glTextureSubImage2D(texture.getRendererID(), upload.Mip, 0, upload.UploadedRows, mipWidth, rows,
+                                    GL_RGBA, GL_UNSIGNED_BYTE, (const void*)(uintptr_t)offset);
+            }
+            else {
+                // A single row larger than the ring, upload it straight from client memory
+                glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+                glTextureSubImage2D(texture.getRendererID(), upload.Mip, 0, upload.UploadedRows, mipWidth, rows,
+                                    GL_RGBA, GL_UNSIGNED_BYTE, pixels + (size_t)upload.UploadedRows * rowSize);
+                glBindBuffer(GL_PIXEL_UNPACK_BUFFER, s_Streamer.PixelBuffer->getRendererID());
+            }
+
+            upload.UploadedRows += rows;
+            budget -= std::min<uint64_t>(budget, size);
+
+            if (upload.UploadedRows == mipHeight) {
+                upload.UploadedRows = 0;
+                if (++upload.Mip == image.MipCount) {
+                    texture.m_IsLoaded = true;
+                    s_Streamer.Uploads.pop_front();
+                }
+            }
+        }
+
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+
+    void TextureStreamer::Shutdown() {
+        {
+            std::lock_guard<std::mutex> lock(s_Streamer.Mutex);
+            s_Streamer.Running = false;
+            s_Streamer.Jobs.clear();
+        }
+        s_Streamer.WorkAvailable.notify_all();
+
+        for (std::thread& worker : s_Streamer.Workers)
+            worker.join();
+        s_Streamer.Workers.clear();
+
+        s_Streamer.Decoded.clear();
+        s_Streamer.Uploads.clear();
+        s_Streamer.Decoding.clear();
+        s_Streamer.DecodeCallbacks.clear();
+        s_Streamer.PixelBuffer.reset();
+    }
+
+    void TextureStreamer::SetUploadBudget(uint64_t bytesPerFrame) {
+        SHADO_CORE_ASSERT(bytesPerFrame > 0 && bytesPerFrame <= UINT32_MAX, "Invalid texture upload budget");
+
+        // The ring is sized by the budget, rebuild it on the next upload
+        s_Streamer.UploadBudget = bytesPerFrame;
+        s_Streamer.PixelBuffer.reset();
+    }
+
+    uint64_t TextureStreamer::GetUploadBudget() {
+        return s_Streamer.UploadBudget;
+    }
+
+    uint32_t TextureStreamer::GetPendingCount() {
+        return (uint32_t)(s_Streamer.Decoding.size() + s_Streamer.DecodeCallbacks.size() + s_Streamer.Uploads.size());
+    }
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <filesystem>
+#include <functional>
+
+#include "Texture2D.h"
+#include "TextureCache.h"
+#include "util/Memory.h"
+
+namespace Shado {
+    /**
+     * Loads textures without stalling the frame. Images are decoded (or mapped from the TextureCache) on worker
+     * threads and uploaded by update() through a pixel buffer ring, at most a fixed number of bytes per frame.
+     * Until the last row of its smallest mip is uploaded a streamed texture reports isLoaded() == false and the renderer draws
+     * the white texture in its place
+     */
+    class TextureStreamer {
+    public:
+        static constexpr uint64_t DefaultUploadBudget = 8 * 1024 * 1024;
+
+        /**
+         * Reads the image header and returns a texture with storage but no pixels yet
+         * @return nullptr if the file is not an image stb_image understands
+         */
+        static Ref<Texture2D> Load(const std::filesystem::path& path);
+
+        /**
+         * Decodes an image through the TextureCache on the streamer workers, without creating a texture
+         * @param done Called on the main thread by update(), with nullptr if the image cannot be read
+         */
+        static void Decode(const std::filesystem::path& path,
+                           std::function<void(ScopedRef<TextureCacheImage> image)> done);
+
+        /** Uploads decoded images, called once per frame on the main thread by the Application */
+        static void Update();
+
+        /** Stops the workers and drops pending uploads. Must run while the GL context is still alive */
+        static void Shutdown();
+
+        static void SetUploadBudget(uint64_t bytesPerFrame);
+        static uint64_t GetUploadBudget();
+
+        /** Number of textures that are still decoding or uploading */
+        static uint32_t GetPendingCount();
+    };
+}
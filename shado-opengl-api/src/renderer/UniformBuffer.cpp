@@ -1,6 +1,8 @@
 ﻿#include "UniformBuffer.h"
 
 #include "GL/glew.h"
+#include "Buffer.h"
+#include <cstring>
 
 namespace Shado {
 
@@ -10,16 +12,46 @@ namespace Shado {
 		glBindBufferBase(GL_UNIFORM_BUFFER, binding, m_RendererID);
 	}
 
+	UniformBuffer::UniformBuffer(uint32_t size, uint32_t binding, uint32_t sectionCount)
+		: m_Size(size), m_Binding(binding), m_Shadow(size, 0) {
+		// Room for several updates per section, a camera block is rewritten once per scene pass
+		constexpr uint32_t updatesPerSection = 64;
+
+		GLint alignment = 256;
+		glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+		const uint32_t alignedSize = (size + alignment - 1) / alignment * alignment;
+
+		m_Stream = CreateScoped<StreamingBuffer>(alignedSize * updatesPerSection, sectionCount, (uint32_t)alignment);
+		m_RendererID = m_Stream->getRendererID();
+		glBindBufferRange(GL_UNIFORM_BUFFER, binding, m_RendererID, 0, size);
+	}
+
 	UniformBuffer::~UniformBuffer() {
-		glDeleteBuffers(1, &m_RendererID);
+		// The stream owns its buffer
+		if (!m_Stream)
+			glDeleteBuffers(1, &m_RendererID);
 	}
 
 	void UniformBuffer::setData(const void* data, uint32_t size, uint32_t offset) {
-		glNamedBufferSubData(m_RendererID, offset, size, data);
+		if (!m_Stream) {
+			glNamedBufferSubData(m_RendererID, offset, size, data);
+			return;
+		}
+
+		SHADO_CORE_ASSERT(offset + size <= m_Size, "Uniform buffer write out of bounds");
+		std::memcpy(m_Shadow.data() + offset, data, size);
+
+		std::memcpy(m_Stream->map(m_Size), m_Shadow.data(), m_Size);
+		const uint32_t streamOffset = m_Stream->commit(m_Size);
+		glBindBufferRange(GL_UNIFORM_BUFFER, m_Binding, m_RendererID, streamOffset, m_Size);
 	}
 
 	Ref<Shado::UniformBuffer> UniformBuffer::create(uint32_t size, uint32_t binding) {
 		return CreateRef<UniformBuffer>(size, binding);
 	}
 
+	Ref<UniformBuffer> UniformBuffer::createStreaming(uint32_t size, uint32_t binding, uint32_t sectionCount) {
+		return CreateRef<UniformBuffer>(size, binding, sectionCount);
+	}
+
 }
@@ -1,17 +1,31 @@
 ﻿#pragma once
 #include "util/Memory.h"
 #include "util/TimeStep.h"
+#include <vector>
 
 namespace Shado {
+    class StreamingBuffer;
+
     class UniformBuffer : public RefCounted {
     public:
         UniformBuffer(uint32_t size, uint32_t binding);
+        UniformBuffer(uint32_t size, uint32_t binding, uint32_t sectionCount);
         virtual ~UniformBuffer();
         virtual void setData(const void* data, uint32_t size, uint32_t offset = 0);
 
         static Ref<UniformBuffer> create(uint32_t size, uint32_t binding);
 
+        /**
+         * Creates a uniform buffer rewritten one or more times per frame. Each setData writes the whole block
+         * to a fresh range of a fenced ring and rebinds it, instead of updating a range the GPU may be reading
+         */
+        static Ref<UniformBuffer> createStreaming(uint32_t size, uint32_t binding, uint32_t sectionCount = 3);
+
     private:
         uint32_t m_RendererID = 0;
+        uint32_t m_Size = 0;
+        uint32_t m_Binding = 0;
+        ScopedRef<StreamingBuffer> m_Stream;
+        std::vector<uint8_t> m_Shadow; // CPU copy of the block, so partial updates can be streamed
     };
 }
@@ -22,6 +22,12 @@ namespace Shado {
 		case ShaderDataType::Int3:		return GL_INT;
 		case ShaderDataType::Int4:		return GL_INT;
 		case ShaderDataType::Bool:		return GL_BOOL;
+		case ShaderDataType::UByte4:	return GL_UNSIGNED_BYTE;
+		case ShaderDataType::UShort2:	return GL_UNSIGNED_SHORT;
+		case ShaderDataType::Half:		return GL_HALF_FLOAT;
+		case ShaderDataType::Half2:		return GL_HALF_FLOAT;
+		case ShaderDataType::Half4:		return GL_HALF_FLOAT;
+		case ShaderDataType::UInt1010102:	return GL_UNSIGNED_INT_2_10_10_10_REV;
 		}
 		SHADO_CORE_ASSERT(false, "Unknown ShaderDataType");
 		return 0;
@@ -60,6 +66,12 @@ namespace Shado {
 			case ShaderDataType::Float2:
 			case ShaderDataType::Float3:
 			case ShaderDataType::Float4:
+			case ShaderDataType::UByte4:
+			case ShaderDataType::UShort2:
+			case ShaderDataType::Half:
+			case ShaderDataType::Half2:
+			case ShaderDataType::Half4:
+			case ShaderDataType::UInt1010102:
 			{
 				glEnableVertexAttribArray(m_VertexBufferIndex);
 				glVertexAttribPointer(m_VertexBufferIndex,
@@ -68,6 +80,8 @@ namespace Shado {
 					element.Normalized ? GL_TRUE : GL_FALSE,
 					layout.getStride(),
 					(const void*)element.Offset);
+				if (layout.getInstanceDivisor())
+					glVertexAttribDivisor(m_VertexBufferIndex, layout.getInstanceDivisor());
 				m_VertexBufferIndex++;
 				break;
 			}
@@ -82,6 +96,8 @@ namespace Shado {
 					toOpenGLType(element.Type),
 					layout.getStride(),
 					(const void*)element.Offset);
+				if (layout.getInstanceDivisor())
+					glVertexAttribDivisor(m_VertexBufferIndex, layout.getInstanceDivisor());
 				m_VertexBufferIndex++;
 				break;
 			}
@@ -0,0 +1,39 @@
+#pragma once
+#include <cstdint>
+
+// Editor builds carry the entity ID of every vertex for mouse picking. Games built with the premake
+// --runtime option set this to 0 and the vertices, layouts and Renderer2D shaders drop it
+#ifndef SHADO_EDITOR_DATA
+    #define SHADO_EDITOR_DATA 1
+#endif
+
+namespace Shado {
+    struct EditorVertexPolicy {
+        static constexpr bool HasEntityID = true;
+    };
+
+    struct RuntimeVertexPolicy {
+        static constexpr bool HasEntityID = false;
+    };
+
+#if SHADO_EDITOR_DATA
+    using VertexPolicy = EditorVertexPolicy;
+#else
+    using VertexPolicy = RuntimeVertexPolicy;
+#endif
+
+    /**
+     * Appends the editor-only entity ID to a vertex (or instance) record. The ID always comes last so the
+     * attributes before it keep their locations in both variants
+     */
+    template<typename Vertex, typename Policy = VertexPolicy>
+    struct WithEntityID : Vertex {
+        int EntityID;
+        void setEntityID(int entityID) { EntityID = entityID; }
+    };
+
+    template<typename Vertex>
+    struct WithEntityID<Vertex, RuntimeVertexPolicy> : Vertex {
+        void setEntityID(int) {}
+    };
+}
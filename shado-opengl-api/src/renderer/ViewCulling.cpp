@@ -0,0 +1,88 @@
+#include "ViewCulling.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace Shado {
+    // Grows rect by the part of segment ab that lies between the depths
+    static void ExtendBySlabSegment(glm::vec4& rect, const glm::vec3& a, const glm::vec3& b, float minZ,
+                                    float maxZ) {
+        float t0 = 0.0f;
+        float t1 = 1.0f;
+
+        const float dz = b.z - a.z;
+        if (std::abs(dz) < 1e-6f) {
+            if (a.z < minZ || a.z > maxZ)
+                return;
+        }
+        else {
+            float enter = (minZ - a.z) / dz;
+            float exit = (maxZ - a.z) / dz;
+            if (enter > exit)
+                std::swap(enter, exit);
+
+            t0 = std::max(t0, enter);
+            t1 = std::min(t1, exit);
+            if (t0 > t1)
+                return;
+        }
+
+        for (const glm::vec3& point : {glm::mix(a, b, t0), glm::mix(a, b, t1)}) {
+            rect.x = std::min(rect.x, point.x);
+            rect.y = std::min(rect.y, point.y);
+            rect.z = std::max(rect.z, point.x);
+            rect.w = std::max(rect.w, point.y);
+        }
+    }
+
+    glm::vec4 ViewCulling::GetViewRect(const glm::mat4& viewProjection, float minZ, float maxZ) {
+        glm::vec4 rect = {FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX};
+        if (minZ > maxZ)
+            return rect;
+
+        // Frustum corners in world space, near face then far face, counter-clockwise
+        const glm::mat4 inverse = glm::inverse(viewProjection);
+        glm::vec3 corners[8];
+        for (int i = 0; i < 8; i++) {
+            const glm::vec4 ndc = {
+                (i & 3) == 1 || (i & 3) == 2 ? 1.0f : -1.0f,
+                (i & 3) >= 2 ? 1.0f : -1.0f,
+                i < 4 ? -1.0f : 1.0f,
+                1.0f
+            };
+            const glm::vec4 world = inverse * ndc;
+            corners[i] = glm::vec3(world) / world.w;
+        }
+
+        // The frustum cut by the depth slab is a convex solid whose vertices all lie on the frustum edges
+        for (int i = 0; i < 4; i++) {
+            const int next = (i + 1) & 3;
+            ExtendBySlabSegment(rect, corners[i], corners[next], minZ, maxZ);
+            ExtendBySlabSegment(rect, corners[i + 4], corners[next + 4], minZ, maxZ);
+            ExtendBySlabSegment(rect, corners[i], corners[i + 4], minZ, maxZ);
+        }
+
+        return rect;
+    }
+
+    glm::vec4 ViewCulling::GetQuadBounds(const glm::mat4& transform, glm::vec2& depthBounds) {
+        // The corners are +-0.5 along the first two columns
+        const glm::vec3 extent = 0.5f * (glm::abs(glm::vec3(transform[0])) + glm::abs(glm::vec3(transform[1])));
+        const glm::vec3 center = transform[3];
+
+        depthBounds = {center.z - extent.z, center.z + extent.z};
+        return {center.x - extent.x, center.y - extent.y, center.x + extent.x, center.y + extent.y};
+    }
+
+    glm::vec4 ViewCulling::GetBounds(const glm::vec3* points, size_t count) {
+        glm::vec4 bounds = {FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX};
+        for (size_t i = 0; i < count; i++) {
+            bounds.x = std::min(bounds.x, points[i].x);
+            bounds.y = std::min(bounds.y, points[i].y);
+            bounds.z = std::max(bounds.z, points[i].x);
+            bounds.w = std::max(bounds.w, points[i].y);
+        }
+        return bounds;
+    }
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <glm/glm.hpp>
+
+#if defined(_M_X64) || defined(__SSE2__)
+    #include <emmintrin.h>
+    #define SHADO_VIEW_CULLING_SSE2 1
+#endif
+
+namespace Shado {
+    /**
+     * 2D view culling helpers. Bounds are world-space rectangles packed as (min x, min y, max x, max y)
+     */
+    class ViewCulling {
+    public:
+        /**
+         * The world rectangle seen through a view-projection by content lying between two depths.
+         * Exact for orthographic cameras looking down Z, conservative for the others
+         * @return An empty rectangle (min > max) if nothing between the depths can be seen
+         */
+        static glm::vec4 GetViewRect(const glm::mat4& viewProjection, float minZ, float maxZ);
+
+        /**
+         * Bounds of the unit quad drawn by sprites and circles under a transform
+         * @param depthBounds Receives the min and max z of the quad
+         */
+        static glm::vec4 GetQuadBounds(const glm::mat4& transform, glm::vec2& depthBounds);
+
+        /**
+         * Bounds of a set of points, e.g. the ends of a line or the corners of a glyph
+         */
+        static glm::vec4 GetBounds(const glm::vec3* points, size_t count);
+
+        /**
+         * @return Whether two rectangles overlap, touching edges included
+         */
+        static bool Overlaps(const glm::vec4& bounds, const glm::vec4& viewRect) {
+#if SHADO_VIEW_CULLING_SSE2
+            const __m128 box = _mm_loadu_ps(&bounds.x);
+            const __m128 view = _mm_loadu_ps(&viewRect.x);
+
+            // (box min, view min) <= (view max, box max) on all four lanes
+            const __m128 mins = _mm_movelh_ps(box, view);
+            const __m128 maxs = _mm_movehl_ps(box, view);
+            return _mm_movemask_ps(_mm_cmple_ps(mins, maxs)) == 0xF;
+#else
+            return bounds.x <= viewRect.z && bounds.y <= viewRect.w &&
+                viewRect.x <= bounds.z && viewRect.y <= bounds.w;
+#endif
+        }
+    };
+}
@@ -1,4 +1,5 @@
 #pragma once
+#include <algorithm>
 #include <glm/glm.hpp>
 
 #define GLM_ENABLE_EXPERIMENTAL
@@ -12,6 +13,7 @@
 #include "renderer/Font.h"
 #include "renderer/Shader.h"
 #include "renderer/Texture2D.h"
+#include "renderer/VertexArray.h"
 #include "script/CSharpObject.h"
 
 namespace Shado {
@@ -35,7 +37,7 @@ namespace Shado {
         glm::vec3 position = {0, 0, 0};
         glm::vec3 rotation = {0, 0, 0};
         glm::vec3 scale = {1.0f, 1.0f, 1.0f};
-        UUID parentId = 0;
+        UUID parentId = 0; // Use setParent, or call Entity::linkToParent after writing it directly
 
         TransformComponent() = default;
 
@@ -44,7 +46,7 @@ namespace Shado {
         TransformComponent(const glm::vec3& position) : position(position) {}
 
         /**
-         * Fetches the total transform of the entity. Meaning localtransform + parent transform recursively
+         * Fetches the total transform of the entity. Meaning parent transform * localtransform recursively
          * @param scene The scene where the entity was created
          * @return Returns the transform matrix of the entity
          */
@@ -55,7 +57,7 @@ namespace Shado {
 
             Entity parent = getParent(scene);
             if (parent.isValid()) {
-                return parent.getComponent<TransformComponent>().getTransform(scene) + localTransform;
+                return parent.getComponent<TransformComponent>().getTransform(scene) * localTransform;
             } else {
                 return localTransform;
             }
@@ -92,6 +94,8 @@ namespace Shado {
                 SHADO_CORE_WARN("setParent was called with invalid parent entity");
                 this->parentId = 0;
             }
+
+            target.linkToParent(parent);
         }
 
         Entity getParent(Scene& sceneToLookup) const {
@@ -99,11 +103,53 @@ namespace Shado {
         }
     };
 
+    /**
+     * Parent/child adjacency as an intrusive doubly linked list of siblings, so child enumeration
+     * costs O(children). Mirrors TransformComponent::parentId and is kept in sync where parentId is written:
+     * TransformComponent::setParent, Entity::linkToParent after copies, and RebuildRelationships after bulk
+     * loads. Never serialized
+     */
+    struct RelationshipComponent : Component {
+        entt::entity parent = entt::null;
+        entt::entity firstChild = entt::null;
+        entt::entity lastChild = entt::null;
+        entt::entity prevSibling = entt::null;
+        entt::entity nextSibling = entt::null;
+        uint32_t childCount = 0;
+    };
+
+    /**
+     * Cached world matrix of an entity (parent world * local). Added with every scene entity and refreshed by
+     * Scene::updateWorldTransforms, never serialized nor copied
+     */
+    struct WorldTransformComponent : Component {
+        glm::mat4 transform = glm::mat4(1.0f);
+        glm::mat4 local = glm::mat4(1.0f);
+
+        // Snapshot of the TransformComponent the matrices were built from
+        glm::vec3 position = {0, 0, 0};
+        glm::vec3 rotation = {0, 0, 0};
+        glm::vec3 scale = {1.0f, 1.0f, 1.0f};
+        UUID parentId = 0;
+
+        // World bounds of the unit quad under transform, for view culling. Min xy then max xy, and min/max z
+        glm::vec4 bounds = {-0.5f, -0.5f, 0.5f, 0.5f};
+        glm::vec2 depthBounds = {0, 0};
+
+        uint32_t generation = 0; // Bumped every time transform changes, children compare against it
+        uint32_t parentGeneration = 0; // Generation of the parent when transform was built
+        uint32_t pass = 0; // Last update pass that visited this entity
+
+        glm::vec3 getPosition() const { return glm::vec3(transform[3]); }
+    };
+
     struct SpriteRendererComponent : Component {
         glm::vec4 color = {1, 1, 1, 1};
         AssetHandle texture = 0;
         float tilingFactor = 1.0f;
         AssetHandle shader = 0;
+        glm::vec4 uvRect = {0, 0, 1, 1}; // Min UV (xy) and max UV (zw) of the texture region to draw
+        bool isStatic = false; // Baked once into the scene's static batch instead of being drawn every frame
 
 
         SpriteRendererComponent() = default;
@@ -129,6 +175,145 @@ namespace Shado {
         //~CircleRendererComponent() { delete texture; }
     };
 
+    /**
+     * What a static sprite looked like when it was baked into the scene's static batch. Owned by
+     * Scene::updateStaticSprites, never serialized nor copied
+     */
+    struct StaticSpriteBakeComponent : Component {
+        uint32_t transformGeneration = 0; // WorldTransformComponent::generation at bake time
+        SpriteRendererComponent sprite;
+
+        bool matches(const SpriteRendererComponent& current, const WorldTransformComponent& world) const {
+            return transformGeneration == world.generation
+                && sprite.color == current.color
+                && sprite.texture == current.texture
+                && sprite.tilingFactor == current.tilingFactor
+                && sprite.shader == current.shader
+                && sprite.uvRect == current.uvRect;
+        }
+    };
+
+    /**
+     * A width x height grid of tiles cut from one atlas texture. Tile (0, 0) is centered on the entity origin,
+     * columns go along +x and rows along +y. Tiles are stored in ChunkSize x ChunkSize chunks, each drawn from
+     * a tilemap space mesh of its own that Renderer2D::DrawTilemap only rewrites after one of its tiles changed.
+     * The mesh buffers are allocated once per chunk. Moving the tilemap does not touch the meshes
+     */
+    struct TilemapComponent : Component {
+        static constexpr uint32_t ChunkSize = 32;
+        static constexpr int32_t EmptyTile = -1;
+
+        struct Chunk {
+            // Atlas index + 1 per tile, 0 when empty. Not allocated until a tile is set
+            std::vector<uint16_t> tiles;
+            uint32_t revision = 1; // Bumped by every tile change
+
+            // Storage for runtime
+            Ref<VertexArray> mesh;
+            uint32_t meshQuadCount = 0;
+            uint32_t meshRevision = 0; // revision the mesh was built from
+            uint32_t meshSettingsRevision = 0; // TilemapComponent::meshSettingsRevision the mesh was built with
+        };
+
+        /**
+         * Everything besides the tiles that is baked into the chunk meshes
+         */
+        struct MeshSettings {
+            glm::vec4 color = {0, 0, 0, 0};
+            glm::vec2 tileSize = {0, 0};
+            glm::uvec2 atlasGrid = {0, 0};
+            AssetHandle atlas = 0;
+
+            bool operator==(const MeshSettings&) const = default;
+        };
+
+        AssetHandle atlas = 0;
+        glm::uvec2 atlasGrid = {1, 1}; // Columns and rows of tiles in the atlas, row 0 at the top
+        glm::vec2 tileSize = {1, 1};
+        glm::vec4 color = {1, 1, 1, 1};
+
+        // Storage for runtime
+        MeshSettings meshSettings;
+        uint32_t meshSettingsRevision = 0;
+
+        TilemapComponent() = default;
+
+        TilemapComponent(const TilemapComponent&) = default;
+
+        /**
+         * Resizes the map, keeping the tiles that still fit
+         */
+        void resize(uint32_t newWidth, uint32_t newHeight) {
+            TilemapComponent resized;
+            resized.width = newWidth;
+            resized.height = newHeight;
+            resized.chunksX = (newWidth + ChunkSize - 1) / ChunkSize;
+            resized.chunksY = (newHeight + ChunkSize - 1) / ChunkSize;
+            resized.chunks.resize(resized.chunksX * resized.chunksY);
+
+            for (uint32_t y = 0; y < std::min(height, newHeight); y++) {
+                for (uint32_t x = 0; x < std::min(width, newWidth); x++) {
+                    const int32_t tile = getTile(x, y);
+                    if (tile != EmptyTile)
+                        resized.setTile(x, y, tile);
+                }
+            }
+
+            width = newWidth;
+            height = newHeight;
+            chunksX = resized.chunksX;
+            chunksY = resized.chunksY;
+            chunks = std::move(resized.chunks);
+        }
+
+        /**
+         * @return The atlas index of a tile, EmptyTile if there is none or the tile is outside the map
+         */
+        int32_t getTile(uint32_t x, uint32_t y) const {
+            if (x >= width || y >= height)
+                return EmptyTile;
+
+            const Chunk& chunk = chunks[(y / ChunkSize) * chunksX + x / ChunkSize];
+            if (chunk.tiles.empty())
+                return EmptyTile;
+            return (int32_t)chunk.tiles[(y % ChunkSize) * ChunkSize + x % ChunkSize] - 1;
+        }
+
+        /**
+         * @param tile Atlas index of the tile, EmptyTile to clear it. Tiles outside the map are ignored
+         */
+        void setTile(uint32_t x, uint32_t y, int32_t tile) {
+            if (x >= width || y >= height || tile < EmptyTile || tile >= UINT16_MAX)
+                return;
+
+            Chunk& chunk = chunks[(y / ChunkSize) * chunksX + x / ChunkSize];
+            if (chunk.tiles.empty()) {
+                if (tile == EmptyTile)
+                    return;
+                chunk.tiles.resize(ChunkSize * ChunkSize, 0);
+            }
+
+            uint16_t& stored = chunk.tiles[(y % ChunkSize) * ChunkSize + x % ChunkSize];
+            if (stored != (uint16_t)(tile + 1)) {
+                stored = (uint16_t)(tile + 1);
+                chunk.revision++;
+            }
+        }
+
+        uint32_t getWidth() const { return width; }
+        uint32_t getHeight() const { return height; }
+        uint32_t getChunksX() const { return chunksX; }
+        uint32_t getChunksY() const { return chunksY; }
+
+        Chunk& getChunk(uint32_t chunkX, uint32_t chunkY) { return chunks[chunkY * chunksX + chunkX]; }
+        const Chunk& getChunk(uint32_t chunkX, uint32_t chunkY) const { return chunks[chunkY * chunksX + chunkX]; }
+
+    private:
+        uint32_t width = 0, height = 0;
+        uint32_t chunksX = 0, chunksY = 0;
+        std::vector<Chunk> chunks;
+    };
+
     struct LineRendererComponent : Component {
         glm::vec3 target = {0, 0, 0};
         glm::vec4 color = {1, 1, 1, 1};
@@ -321,5 +506,5 @@ namespace Shado {
     ComponentGroup<TagComponent, TransformComponent, SpriteRendererComponent,
                    CircleRendererComponent, LineRendererComponent, CameraComponent, ScriptComponent,
                    NativeScriptComponent, RigidBody2DComponent, BoxCollider2DComponent,
-                   CircleCollider2DComponent, PrefabInstanceComponent, TextComponent>;
+                   CircleCollider2DComponent, PrefabInstanceComponent, TextComponent, TilemapComponent>;
 }
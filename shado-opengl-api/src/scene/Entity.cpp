@@ -34,22 +34,72 @@ namespace Shado {
 	std::vector<Entity> Entity::getChildren() const {
 		std::vector<Entity> children;
 
-		for (auto e : getRegistry().view<TransformComponent>()) {
-			Entity currentIt;
-			if (m_Scene != nullptr)
-				currentIt = { e, m_Scene };
-			else 
-				currentIt = { e, m_Registry };
+		auto& registry = getRegistry();
+		const auto* relationship = registry.try_get<RelationshipComponent>(m_EntityHandle);
+		if (relationship == nullptr)
+			return children;
 
-			const TransformComponent& tc = currentIt.getComponent<TransformComponent>();
-			if (tc.parentId == this->getUUID()) {
-				children.push_back(currentIt);
-			}
+		children.reserve(relationship->childCount);
+		for (entt::entity child = relationship->firstChild; child != entt::null;
+			child = registry.get<RelationshipComponent>(child).nextSibling) {
+			if (m_Scene != nullptr)
+				children.push_back({ child, m_Scene });
+			else
+				children.push_back({ child, m_Registry });
 		}
 
 		return children;
 	}
 
+	void Entity::linkToParent(Entity parent) {
+		auto& registry = getRegistry();
+		SHADO_CORE_ASSERT(!parent || &parent.getRegistry() == &registry, "Parent must live in the same registry");
+
+		// Emplace everything first, references into the pool are not stable across emplaces
+		registry.get_or_emplace<RelationshipComponent>(m_EntityHandle);
+		if (parent)
+			registry.get_or_emplace<RelationshipComponent>(parent.m_EntityHandle);
+
+		auto& relationship = registry.get<RelationshipComponent>(m_EntityHandle);
+
+		// Unlink from the old parent
+		if (relationship.parent != entt::null && registry.valid(relationship.parent)) {
+			auto& oldParent = registry.get<RelationshipComponent>(relationship.parent);
+
+			if (relationship.prevSibling != entt::null)
+				registry.get<RelationshipComponent>(relationship.prevSibling).nextSibling = relationship.nextSibling;
+			else
+				oldParent.firstChild = relationship.nextSibling;
+
+			if (relationship.nextSibling != entt::null)
+				registry.get<RelationshipComponent>(relationship.nextSibling).prevSibling = relationship.prevSibling;
+			else
+				oldParent.lastChild = relationship.prevSibling;
+
+			oldParent.childCount--;
+		}
+
+		relationship.parent = entt::null;
+		relationship.prevSibling = entt::null;
+		relationship.nextSibling = entt::null;
+
+		if (!parent || parent.m_EntityHandle == m_EntityHandle)
+			return;
+
+		// Append so children keep the order they were parented in
+		auto& newParent = registry.get<RelationshipComponent>(parent.m_EntityHandle);
+		relationship.parent = parent.m_EntityHandle;
+		relationship.prevSibling = newParent.lastChild;
+
+		if (newParent.lastChild != entt::null)
+			registry.get<RelationshipComponent>(newParent.lastChild).nextSibling = m_EntityHandle;
+		else
+			newParent.firstChild = m_EntityHandle;
+
+		newParent.lastChild = m_EntityHandle;
+		newParent.childCount++;
+	}
+
 	bool Entity::isChild(Scene& sceneToLookup) const {
 		return getComponent<TransformComponent>().getParent(sceneToLookup).isValid();
 	}
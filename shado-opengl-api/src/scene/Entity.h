@@ -57,6 +57,13 @@ namespace Shado {
 
         std::vector<Entity> getChildren() const;
 
+        /**
+         * Moves this entity under parent in the relationship lists. Does not touch TransformComponent::parentId,
+         * use TransformComponent::setParent for that
+         * @param parent The new parent, or an invalid entity to detach this entity
+         */
+        void linkToParent(Entity parent);
+
         operator bool() const { return isValid(); }
         operator uint32_t() const { return (uint32_t)m_EntityHandle; }
         operator entt::entity() const { return m_EntityHandle; }
@@ -19,6 +19,7 @@ namespace Shado {
                 entity.addOrReplaceComponent<IDComponent>().id = uuid;
                 return entity;
             });
+            RebuildRelationships(registry);
 
             // Find root
             auto view = registry.view<PrefabInstanceComponent>();
@@ -13,8 +13,13 @@
 #include "asset/AssetManager.h" // <--- This is needed DO NOT REMOVE
 #include "debug/Profile.h"
 #include "renderer/Renderer2D.h"
+#include "renderer/ViewCulling.h"
 #include "script/ScriptEngine.h"
 
+#include <array>
+#include <cfloat>
+#include <thread>
+
 namespace Shado {
     /**
      * **********************************
@@ -154,6 +159,7 @@ namespace Shado {
         CopyRegistries(srcSceneRegistry, dstSceneRegistry, [this](const auto& tag, auto uuid) {
             return this->createEntityWithUUID(tag, uuid);
         });
+        RebuildRelationships(dstSceneRegistry);
 
         other.m_ScriptStorage.CopyTo(this->m_ScriptStorage);
     }
@@ -170,6 +176,9 @@ namespace Shado {
 
         entity.addComponent<IDComponent>().id = uuid;
         entity.addComponent<TransformComponent>();
+        entity.addComponent<WorldTransformComponent>();
+        entity.addComponent<RelationshipComponent>();
+        m_EntityMap[uuid] = id;
 
         auto& tag = entity.addComponent<TagComponent>();
         tag.tag = name.empty() ? std::string("Entity ") + std::to_string((uint64_t)uuid) : name;
@@ -191,6 +200,7 @@ namespace Shado {
         CopyComponentIfExists<CircleCollider2DComponent>(newEntity, source);
         CopyComponentIfExists<PrefabInstanceComponent>(newEntity, source);
         CopyComponentIfExists<TextComponent>(newEntity, source);
+        CopyComponentIfExists<TilemapComponent>(newEntity, source);
 
         // Script should always be last
         CopyComponentIfExists<ScriptComponent>(newEntity, source);
@@ -202,6 +212,157 @@ namespace Shado {
         }
     }
 
+    /**
+     * Draws every sprite. Large scenes are split in chunks whose vertices are generated by worker threads,
+     * then merged in chunk order so the frame is the same as a serial submission
+     */
+    static void DrawSprites(entt::registry& registry) {
+        SHADO_PROFILE_FUNCTION();
+
+        // Below this many sprites per worker, waking the workers costs more than it saves
+        constexpr uint32_t minSpritesPerWorker = 1024;
+
+        auto group = registry.group<TransformComponent>(entt::get<SpriteRendererComponent>);
+        auto worldTransforms = registry.view<WorldTransformComponent>();
+        const uint32_t spriteCount = (uint32_t)group.size();
+        const uint32_t workerCount = std::min(std::max(std::thread::hardware_concurrency(), 1u),
+                                              spriteCount / minSpritesPerWorker);
+
+        if (workerCount <= 1) {
+            // Flat colored sprites are gathered and handed to the renderer a run at a time
+            constexpr size_t runSize = 256;
+            std::array<glm::mat4, runSize> runTransforms;
+            std::array<glm::vec4, runSize> runColors;
+            std::array<int, runSize> runEntities;
+            size_t runCount = 0;
+
+            auto flushRun = [&] {
+                Renderer2D::DrawQuads({runTransforms.data(), runCount}, {runColors.data(), runCount},
+                                      {runEntities.data(), runCount});
+                runCount = 0;
+            };
+
+            for (auto entity : group) {
+                auto& sprite = group.get<SpriteRendererComponent>(entity);
+                const auto& transform = worldTransforms.get<WorldTransformComponent>(entity);
+                if (sprite.isStatic || !Renderer2D::IsVisible(transform.bounds))
+                    continue;
+
+                if (sprite.texture || sprite.shader) {
+                    Renderer2D::DrawSprite(transform.transform, sprite, (int)entity);
+                    continue;
+                }
+
+                runTransforms[runCount] = transform.transform;
+                runColors[runCount] = sprite.color;
+                runEntities[runCount] = (int)entity;
+                if (++runCount == runSize)
+                    flushRun();
+            }
+
+            if (runCount > 0)
+                flushRun();
+            return;
+        }
+
+        // Workers only read the components, the registry is not modified until every chunk is merged
+        auto record = [&group, &worldTransforms](Renderer2DRecorder* recorder, uint32_t begin, uint32_t end) {
+            SHADO_PROFILE_SCOPE("Scene::DrawSprites worker");
+
+            recorder->reset();
+            for (auto it = group.begin() + begin, last = group.begin() + end; it != last; ++it) {
+                const auto& sprite = group.get<SpriteRendererComponent>(*it);
+                const auto& transform = worldTransforms.get<WorldTransformComponent>(*it);
+                if (sprite.isStatic || !recorder->isVisible(transform.bounds))
+                    continue;
+
+                recorder->drawSprite(transform.transform, sprite, (int)*it);
+            }
+        };
+
+        // Chunks run on the renderer's persistent workers, the main thread records the first one
+        const uint32_t chunkSize = (spriteCount + workerCount - 1) / workerCount;
+        Renderer2D::RecordParallel(workerCount, [&](Renderer2DRecorder& recorder, uint32_t worker) {
+            const uint32_t begin = std::min(worker * chunkSize, spriteCount);
+            record(&recorder, begin, std::min(begin + chunkSize, spriteCount));
+        });
+
+        for (uint32_t worker = 0; worker < workerCount; worker++)
+            Renderer2D::Submit(Renderer2D::GetRecorder(worker));
+    }
+
+    /**
+     * Draws every renderable component of the scene, culled against the camera of the current Renderer2D scene
+     * @param depthBounds Min and max world z of the entity transforms
+     * @param staticSprites The baked static sprites, may be null
+     */
+    static void DrawRenderables(entt::registry& registry, glm::vec2 depthBounds,
+                                const StaticSpriteBatch* staticSprites) {
+        SHADO_PROFILE_FUNCTION();
+
+        // Line targets are not part of any transform, the culling depths must include them
+        auto lines = registry.view<WorldTransformComponent, LineRendererComponent>();
+        for (auto entity : lines) {
+            const float targetZ = lines.get<LineRendererComponent>(entity).target.z;
+            depthBounds = {std::min(depthBounds.x, targetZ), std::max(depthBounds.y, targetZ)};
+        }
+
+        // Neither do the corners of a tilted tilemap
+        auto tilemaps = registry.view<WorldTransformComponent, TilemapComponent>();
+        for (auto entity : tilemaps) {
+            auto [transform, tilemap] = tilemaps.get<WorldTransformComponent, TilemapComponent>(entity);
+            const glm::vec2 extent = glm::vec2(tilemap.getWidth(), tilemap.getHeight()) * tilemap.tileSize;
+            const glm::vec2 slope = {transform.transform[0].z, transform.transform[1].z};
+            const float z = transform.transform[3].z - 0.5f * glm::dot(slope, tilemap.tileSize);
+            const glm::vec2 corners[4] = {{0.0f, 0.0f}, {extent.x, 0.0f}, {0.0f, extent.y}, extent};
+            for (const glm::vec2& corner : corners) {
+                const float cornerZ = z + glm::dot(slope, corner);
+                depthBounds = {std::min(depthBounds.x, cornerZ), std::max(depthBounds.y, cornerZ)};
+            }
+        }
+        Renderer2D::SetCullingDepthRange(depthBounds.x, depthBounds.y);
+
+        for (auto entity : tilemaps) {
+            auto [transform, tilemap] = tilemaps.get<WorldTransformComponent, TilemapComponent>(entity);
+            Renderer2D::DrawTilemap(transform.transform, tilemap, (int)entity);
+        }
+
+        if (staticSprites)
+            Renderer2D::DrawStaticBatch(*staticSprites);
+        DrawSprites(registry);
+
+        auto circles = registry.view<WorldTransformComponent, CircleRendererComponent>();
+        for (auto entity : circles) {
+            auto [transform, circle] = circles.get<WorldTransformComponent, CircleRendererComponent>(entity);
+            if (!Renderer2D::IsVisible(transform.bounds))
+                continue;
+
+            if (circle.texture) {
+                Renderer2D::DrawCircle(transform.transform, circle.texture, circle.tilingFactor,
+                                       circle.color, circle.thickness, circle.fade, (int)entity);
+            } else {
+                Renderer2D::DrawCircle(transform.transform, circle.color, circle.thickness, circle.fade,
+                                       (int)entity);
+            }
+        }
+
+        for (auto entity : lines) {
+            auto [transform, line] = lines.get<WorldTransformComponent, LineRendererComponent>(entity);
+            const glm::vec3 ends[2] = {transform.getPosition(), line.target};
+            if (!Renderer2D::IsVisible(ViewCulling::GetBounds(ends, 2)))
+                continue;
+
+            Renderer2D::DrawLine(ends[0], ends[1], line.color, (int)entity);
+        }
+
+        // Text has no bounds before layout, DrawString culls it glyph by glyph
+        auto texts = registry.view<WorldTransformComponent, TextComponent>();
+        for (auto entity : texts) {
+            auto [transform, text] = texts.get<WorldTransformComponent, TextComponent>(entity);
+            Renderer2D::DrawString(transform.transform, text, (int)entity);
+        }
+    }
+
     static Entity duplicateEntityWithUUID(Scene& scene, Entity source, UUID id, bool modifyTag,
                                           bool copyScriptStorage = true) {
         if (!source)
@@ -213,6 +374,9 @@ namespace Shado {
 
         CopyAllComponentsHelper(newEntity, source, scene.GetScriptStorage(), true, copyScriptStorage);
 
+        // The duplicate is a sibling of the source
+        newEntity.linkToParent(newEntity.getComponent<TransformComponent>().getParent(scene));
+
         return newEntity;
     }
 
@@ -265,6 +429,8 @@ namespace Shado {
             }
         }
 
+        entity.linkToParent({});
+        m_EntityMap.erase(entity.getUUID());
         m_Registry.destroy(entity);
     }
 
@@ -507,18 +673,21 @@ namespace Shado {
     }
 
     void Scene::onDrawRuntime() {
+        updateWorldTransforms();
+        updateStaticSprites();
+
         // Render 2D: Cameras
         Camera* primaryCamera = nullptr;
         glm::mat4 cameraTransform;
         {
             // Loop through ortho cameras
-            auto group = m_Registry.view<TransformComponent, CameraComponent>();
+            auto group = m_Registry.view<WorldTransformComponent, CameraComponent>();
             for (auto entity : group) {
-                auto [transform, camera] = group.get<TransformComponent, CameraComponent>(entity);
+                auto [transform, camera] = group.get<WorldTransformComponent, CameraComponent>(entity);
 
                 if (camera.primary) {
                     primaryCamera = camera.camera.Raw();
-                    cameraTransform = transform.getTransform(*this);
+                    cameraTransform = transform.transform;
                     break;
                 }
             }
@@ -528,98 +697,138 @@ namespace Shado {
         if (primaryCamera) {
             Renderer2D::BeginScene(*primaryCamera, cameraTransform);
 
-            // Render stuff
-            auto group = m_Registry.group<TransformComponent>(entt::get<SpriteRendererComponent>);
-            for (auto entity : group) {
-                auto [transform, sprite] = group.get<TransformComponent, SpriteRendererComponent>(entity);
-                Renderer2D::DrawSprite(transform.getTransform(*this), sprite, (int)entity);
-            }
+            DrawRenderables(m_Registry, m_DepthBounds, m_StaticSprites.get());
+            Renderer2D::EndScene();
+        }
+    }
 
-            // Draw circles
-            {
-                auto view = m_Registry.view<TransformComponent, CircleRendererComponent>();
-                for (auto entity : view) {
-                    auto [transform, circle] = view.get<TransformComponent, CircleRendererComponent>(entity);
-
-                    if (circle.texture) {
-                        Renderer2D::DrawCircle(transform.getTransform(*this), circle.texture, circle.tilingFactor,
-                                               circle.color, circle.thickness, circle.fade, (int)entity);
-                    } else {
-                        Renderer2D::DrawCircle(transform.getTransform(*this), circle.color, circle.thickness,
-                                               circle.fade, (int)entity);
-                    }
-                }
-            }
+    void Scene::onUpdateEditor(TimeStep ts, EditorCamera& camera) {}
 
-            // Draw lines
-            {
-                auto view = m_Registry.view<TransformComponent, LineRendererComponent>();
-                for (auto entity : view) {
-                    auto [transform, line] = view.get<TransformComponent, LineRendererComponent>(entity);
-                    Renderer2D::DrawLine(transform.getPosition(*this), line.target, line.color, (int)entity);
-                }
-            }
+    void Scene::onDrawEditor(EditorCamera& camera) {
+        updateWorldTransforms();
+        updateStaticSprites();
 
-            // Draw Text
-            {
-                auto view = m_Registry.view<TransformComponent, TextComponent>();
-                for (auto entity : view) {
-                    auto [transform, text] = view.get<TransformComponent, TextComponent>(entity);
-                    Renderer2D::DrawString(transform.getTransform(*this), text, (int)entity);
-                }
+        Renderer2D::BeginScene(camera);
+        DrawRenderables(m_Registry, m_DepthBounds, m_StaticSprites.get());
+        Renderer2D::EndScene();
+    }
+
+    void Scene::updateWorldTransforms() {
+        SHADO_PROFILE_FUNCTION();
+
+        m_TransformPass++;
+        m_DepthBounds = {FLT_MAX, -FLT_MAX};
+
+        // Every scene entity gets all three in createEntityWithUUID
+        auto view = m_Registry.view<TransformComponent, WorldTransformComponent, RelationshipComponent>();
+        for (auto entity : view) {
+            // Collect the ancestors not yet visited this pass so they get resolved parent-before-child.
+            // Stamping before resolving also stops parent cycles from looping forever
+            m_TransformChain.clear();
+            entt::entity current = entity;
+            while (current != entt::null) {
+                auto& world = view.get<WorldTransformComponent>(current);
+                if (world.pass == m_TransformPass)
+                    break;
+
+                world.pass = m_TransformPass;
+                m_TransformChain.push_back(current);
+                current = view.get<RelationshipComponent>(current).parent;
             }
 
-            Renderer2D::EndScene();
+            for (auto it = m_TransformChain.rbegin(); it != m_TransformChain.rend(); ++it)
+                updateWorldTransform(*it);
+
+            const glm::vec2& depth = view.get<WorldTransformComponent>(entity).depthBounds;
+            m_DepthBounds = {std::min(m_DepthBounds.x, depth.x), std::max(m_DepthBounds.y, depth.y)};
         }
     }
 
-    void Scene::onUpdateEditor(TimeStep ts, EditorCamera& camera) {}
+    void Scene::updateWorldTransform(entt::entity entity) {
+        const auto& transform = m_Registry.get<TransformComponent>(entity);
+        auto& world = m_Registry.get<WorldTransformComponent>(entity);
 
-    void Scene::onDrawEditor(EditorCamera& camera) {
-        Renderer2D::BeginScene(camera);
+        // The relationship mirrors parentId, following it avoids a UUID lookup per entity
+        const entt::entity parent = m_Registry.get<RelationshipComponent>(entity).parent;
+        const WorldTransformComponent* parentWorld = parent != entt::null
+                                                         ? &m_Registry.get<WorldTransformComponent>(parent)
+                                                         : nullptr;
+
+        const uint32_t parentGeneration = parentWorld ? parentWorld->generation : 0;
+        const bool localChanged = world.generation == 0
+            || world.position != transform.position
+            || world.rotation != transform.rotation
+            || world.scale != transform.scale
+            || world.parentId != transform.parentId;
+
+        if (!localChanged && world.parentGeneration == parentGeneration)
+            return;
 
-        // Render Quads stuff
-        auto group = m_Registry.group<TransformComponent>(entt::get<SpriteRendererComponent>);
-        for (auto entity : group) {
-            auto [transform, sprite] = group.get<TransformComponent, SpriteRendererComponent>(entity);
-            Renderer2D::DrawSprite(transform.getTransform(*this), sprite, (int)entity);
+#ifdef SHADO_ENABLE_ASSERTS
+        if (world.parentId != transform.parentId) {
+            Entity expected = getEntityById(transform.parentId);
+            SHADO_CORE_ASSERT(parent == (expected ? (entt::entity)expected : entt::null),
+                              "parentId of entity {} was written without relinking it", (uint32_t)entity);
         }
+#endif
 
-        // Draw circles
-        {
-            auto view = m_Registry.view<TransformComponent, CircleRendererComponent>();
-            for (auto entity : view) {
-                auto [transform, circle] = view.get<TransformComponent, CircleRendererComponent>(entity);
-
-                if (circle.texture) {
-                    Renderer2D::DrawCircle(transform.getTransform(*this), circle.texture, circle.tilingFactor,
-                                           circle.color, circle.thickness, circle.fade, (int)entity);
-                } else {
-                    Renderer2D::DrawCircle(transform.getTransform(*this), circle.color, circle.thickness, circle.fade,
-                                           (int)entity);
-                }
-            }
+        if (localChanged) {
+            world.local = transform.getLocalTransform();
+            world.position = transform.position;
+            world.rotation = transform.rotation;
+            world.scale = transform.scale;
+            world.parentId = transform.parentId;
         }
 
-        // Draw lines
-        {
-            auto view = m_Registry.view<TransformComponent, LineRendererComponent>();
-            for (auto entity : view) {
-                auto [transform, line] = view.get<TransformComponent, LineRendererComponent>(entity);
-                Renderer2D::DrawLine(transform.getPosition(*this), line.target, line.color, (int)entity);
-            }
+        world.transform = parentWorld ? parentWorld->transform * world.local : world.local;
+        world.bounds = ViewCulling::GetQuadBounds(world.transform, world.depthBounds);
+        world.parentGeneration = parentGeneration;
+        world.generation++;
+    }
+
+    void Scene::updateStaticSprites() {
+        SHADO_PROFILE_FUNCTION();
+
+        auto view = m_Registry.view<WorldTransformComponent, SpriteRendererComponent>();
+
+        // The bake is stale when a static sprite changed, appeared or went away since the last one
+        uint32_t staticCount = 0;
+        bool stale = false;
+        for (auto entity : view) {
+            const auto& sprite = view.get<SpriteRendererComponent>(entity);
+            if (!sprite.isStatic)
+                continue;
+
+            staticCount++;
+            const auto* bake = m_Registry.try_get<StaticSpriteBakeComponent>(entity);
+            if (bake == nullptr || !bake->matches(sprite, view.get<WorldTransformComponent>(entity)))
+                stale = true;
         }
 
-        // Draw Text
-        {
-            auto view = m_Registry.view<TransformComponent, TextComponent>();
-            for (auto entity : view) {
-                auto [transform, text] = view.get<TransformComponent, TextComponent>(entity);
-                Renderer2D::DrawString(transform.getTransform(*this), text, (int)entity);
+        if (!stale && staticCount == m_StaticSpriteCount)
+            return;
+
+        if (!m_StaticSprites)
+            m_StaticSprites = CreateScoped<StaticSpriteBatch>();
+        m_StaticSprites->clear();
+
+        for (auto entity : view) {
+            const auto& sprite = view.get<SpriteRendererComponent>(entity);
+            if (!sprite.isStatic) {
+                m_Registry.remove<StaticSpriteBakeComponent>(entity);
+                continue;
             }
+
+            const auto& world = view.get<WorldTransformComponent>(entity);
+            m_StaticSprites->addSprite(world.transform, sprite, (int)entity);
+
+            auto& bake = m_Registry.emplace_or_replace<StaticSpriteBakeComponent>(entity);
+            bake.transformGeneration = world.generation;
+            bake.sprite = sprite;
         }
 
-        Renderer2D::EndScene();
+        m_StaticSprites->build();
+        m_StaticSpriteCount = staticCount;
     }
 
     void Scene::onViewportResize(uint32_t width, uint32_t height) {
@@ -650,14 +859,14 @@ namespace Shado {
     }
 
     Entity Scene::getEntityById(uint64_t entityId) {
-        auto ids = m_Registry.view<IDComponent>();
-        for (auto entity : ids) {
-            const auto& idComponent = ids.get<IDComponent>(entity);
+        if (entityId == 0)
+            return {};
 
-            if (idComponent.id == entityId)
-                return {entity, this};
-        }
-        return {};
+        auto it = m_EntityMap.find(entityId);
+        if (it == m_EntityMap.end() || !m_Registry.valid(it->second))
+            return {};
+
+        return {it->second, this};
     }
 
     Entity Scene::findEntityByName(std::string_view name) {
@@ -780,6 +989,29 @@ namespace Shado {
         CopyComponent<CircleCollider2DComponent>(dstSceneRegistry, srcSceneRegistry, enttMap);
         CopyComponent<PrefabInstanceComponent>(dstSceneRegistry, srcSceneRegistry, enttMap);
         CopyComponent<TextComponent>(dstSceneRegistry, srcSceneRegistry, enttMap);
+        CopyComponent<TilemapComponent>(dstSceneRegistry, srcSceneRegistry, enttMap);
         CopyComponent<ScriptComponent>(dstSceneRegistry, srcSceneRegistry, enttMap);
     }
+
+    void RebuildRelationships(entt::registry& registry) {
+        SHADO_PROFILE_FUNCTION();
+
+        std::unordered_map<UUID, entt::entity> handles;
+        auto ids = registry.view<IDComponent>();
+        for (auto e : ids) {
+            handles[ids.get<IDComponent>(e).id] = e;
+            registry.emplace_or_replace<RelationshipComponent>(e);
+        }
+
+        auto view = registry.view<TransformComponent>();
+        for (auto e : view) {
+            UUID parentId = view.get<TransformComponent>(e).parentId;
+            if (parentId == 0)
+                continue;
+
+            auto it = handles.find(parentId);
+            if (it != handles.end())
+                Entity(e, &registry).linkToParent({it->second, &registry});
+        }
+    }
 }
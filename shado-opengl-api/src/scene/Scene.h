@@ -13,6 +13,7 @@ class b2World;
 namespace Shado {
     class Entity;
     class Prefab;
+    class StaticSpriteBatch;
 
     class SceneChangedEvent : public Event {
     public:
@@ -56,7 +57,18 @@ namespace Shado {
 
         void onViewportResize(uint32_t width, uint32_t height);
 
+        /**
+         * Refreshes the cached WorldTransformComponent of every entity, parents before children.
+         * Only entities whose local transform, parent or parent world matrix changed are recomputed
+         */
+        void updateWorldTransforms();
+
         Entity getPrimaryCameraEntity();
+        /**
+         * Resolves an entity through the scene's UUID index. O(1), does not touch the registry views
+         * @param id The UUID of the entity
+         * @return The entity or an invalid entity if no entity has this UUID in this scene
+         */
         Entity getEntityById(uint64_t id);
         Entity findEntityByName(std::string_view name);
         const entt::registry& getRegistry() { return m_Registry; }
@@ -77,15 +89,29 @@ namespace Shado {
         inline static Ref<Scene> ActiveScene = nullptr; // TODO: remove this
     private:
         Entity instantiatePrefabHelper(Ref<Prefab> prefab, Entity toDuplicate, bool modifyTag = true);
+        void updateWorldTransform(entt::entity entity);
+        /**
+         * Rebakes the static sprite batch if a static sprite was added, removed, moved or edited since the last bake
+         */
+        void updateStaticSprites();
 
     private:
         entt::registry m_Registry;
+        // UUID -> entt handle index. Kept in sync by createEntityWithUUID and destroyEntity
+        std::unordered_map<UUID, entt::entity> m_EntityMap;
         uint32_t m_ViewportWidth = 0;
         uint32_t m_ViewportHeight = 0;
         std::string name = "Untitled";
 
         std::vector<Entity> toDestroy;
 
+        uint32_t m_TransformPass = 0;
+        std::vector<entt::entity> m_TransformChain; // Scratch buffer reused by updateWorldTransforms
+        glm::vec2 m_DepthBounds = {0, 0}; // Min and max world z of the entities, for view culling
+
+        ScopedRef<StaticSpriteBatch> m_StaticSprites;
+        uint32_t m_StaticSpriteCount = 0; // Static sprites in the last bake
+
         b2World* m_World = nullptr;
         bool m_PhysicsEnabled = true;
 
@@ -101,4 +127,9 @@ namespace Shado {
 
     // Utility functions
     void CopyRegistries(entt::registry& source, entt::registry& dest, std::function<Entity(const std::string&, UUID)>);
+    /**
+     * Rebuilds every RelationshipComponent of a registry from the TransformComponent::parentId values.
+     * Needed after bulk operations that write parentId directly (registry copies, deserialization)
+     */
+    void RebuildRelationships(entt::registry& registry);
 }
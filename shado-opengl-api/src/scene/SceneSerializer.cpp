@@ -2,6 +2,7 @@
 #include "debug/Profile.h"
 #include <yaml-cpp/yaml.h>
 #include <fstream>
+#include <algorithm>
 
 #include "Components.h"
 #include "project/Project.h"
@@ -225,6 +226,8 @@ namespace Shado {
                     }, m_Scene, m_Scene->m_ScriptStorage);
                 }
             }
+
+            RebuildRelationships(m_Scene->m_Registry);
         }
         catch (const YAML::Exception& e) {
             error = e.what();
@@ -250,7 +253,8 @@ namespace Shado {
         auto children = node["Children"];
         if (children) {
             for (auto child : children) {
-                deserializePrefabHelper(child, prefab);
+                Entity childEntity = deserializePrefabHelper(child, prefab);
+                childEntity.linkToParent(entity);
             }
         }
 
@@ -350,6 +354,8 @@ namespace Shado {
             out << YAML::Key << "TextureHandle" << YAML::Value << spriteRendererComponent.texture;
             out << YAML::Key << "TilingFactor" << YAML::Value << spriteRendererComponent.tilingFactor;
             out << YAML::Key << "ShaderHandle" << YAML::Value << spriteRendererComponent.shader;
+            out << YAML::Key << "UVRect" << YAML::Value << spriteRendererComponent.uvRect;
+            out << YAML::Key << "IsStatic" << YAML::Value << spriteRendererComponent.isStatic;
 
             //     auto& shader = spriteRendererComponent.shader;
             //     out << YAML::Key << "ShaderCustomUniforms" << YAML::Value;
@@ -667,6 +673,46 @@ namespace Shado {
             out << YAML::EndMap; // TextRendererComponent
         }
 
+        if (entity.hasComponent<TilemapComponent>()) {
+            out << YAML::Key << "TilemapComponent";
+            out << YAML::BeginMap; // TilemapComponent
+
+            auto& tilemapComponent = entity.getComponent<TilemapComponent>();
+            out << YAML::Key << "AtlasHandle" << YAML::Value << tilemapComponent.atlas;
+            out << YAML::Key << "AtlasColumns" << YAML::Value << tilemapComponent.atlasGrid.x;
+            out << YAML::Key << "AtlasRows" << YAML::Value << tilemapComponent.atlasGrid.y;
+            out << YAML::Key << "TileSize" << YAML::Value << tilemapComponent.tileSize;
+            out << YAML::Key << "Color" << YAML::Value << tilemapComponent.color;
+            out << YAML::Key << "Width" << YAML::Value << tilemapComponent.getWidth();
+            out << YAML::Key << "Height" << YAML::Value << tilemapComponent.getHeight();
+
+            // Only the chunks holding tiles, each as its little endian uint16 tiles in base64
+            out << YAML::Key << "Chunks" << YAML::Value << YAML::BeginSeq;
+            std::vector<unsigned char> bytes;
+            for (uint32_t chunkY = 0; chunkY < tilemapComponent.getChunksY(); chunkY++) {
+                for (uint32_t chunkX = 0; chunkX < tilemapComponent.getChunksX(); chunkX++) {
+                    const auto& tiles = tilemapComponent.getChunk(chunkX, chunkY).tiles;
+                    if (std::none_of(tiles.begin(), tiles.end(), [](uint16_t tile) { return tile != 0; }))
+                        continue;
+
+                    bytes.clear();
+                    for (uint16_t tile : tiles) {
+                        bytes.push_back((unsigned char)(tile & 0xFF));
+                        bytes.push_back((unsigned char)(tile >> 8));
+                    }
+
+                    out << YAML::BeginMap;
+                    out << YAML::Key << "X" << YAML::Value << chunkX;
+                    out << YAML::Key << "Y" << YAML::Value << chunkY;
+                    out << YAML::Key << "Tiles" << YAML::Value << YAML::Binary(bytes.data(), bytes.size());
+                    out << YAML::EndMap;
+                }
+            }
+            out << YAML::EndSeq;
+
+            out << YAML::EndMap; // TilemapComponent
+        }
+
         if (endmap)
             out << YAML::EndMap; // Entity
     }
@@ -767,6 +813,12 @@ namespace Shado {
             if (spriteRendererComponent["TextureHandle"])
                 src.texture = spriteRendererComponent["TextureHandle"].as<AssetHandle>();
 
+            if (spriteRendererComponent["UVRect"])
+                src.uvRect = spriteRendererComponent["UVRect"].as<glm::vec4>();
+
+            if (spriteRendererComponent["IsStatic"])
+                src.isStatic = spriteRendererComponent["IsStatic"].as<bool>();
+
             if (spriteRendererComponent["ShaderHandle"]) {
                 try {
                     src.shader = spriteRendererComponent["ShaderHandle"].as<AssetHandle>();
@@ -1137,6 +1189,34 @@ namespace Shado {
             trc.font = CreateRef<Font>(textRendererComponent["Font"].as<std::string>());
         }
 
+        auto tilemapComponent = entity["TilemapComponent"];
+        if (tilemapComponent) {
+            auto& tc = deserializedEntity.addComponent<TilemapComponent>();
+            tc.atlas = tilemapComponent["AtlasHandle"].as<AssetHandle>();
+            tc.atlasGrid.x = tilemapComponent["AtlasColumns"].as<uint32_t>();
+            tc.atlasGrid.y = tilemapComponent["AtlasRows"].as<uint32_t>();
+            tc.tileSize = tilemapComponent["TileSize"].as<glm::vec2>();
+            tc.color = tilemapComponent["Color"].as<glm::vec4>();
+            tc.resize(tilemapComponent["Width"].as<uint32_t>(), tilemapComponent["Height"].as<uint32_t>());
+
+            constexpr uint32_t chunkSize = TilemapComponent::ChunkSize;
+            for (auto chunk : tilemapComponent["Chunks"]) {
+                const uint32_t chunkX = chunk["X"].as<uint32_t>();
+                const uint32_t chunkY = chunk["Y"].as<uint32_t>();
+                const YAML::Binary tiles = chunk["Tiles"].as<YAML::Binary>();
+                if (tiles.size() != chunkSize * chunkSize * 2) {
+                    SHADO_CORE_WARN("Skipping tilemap chunk ({}, {}) of {} bytes", chunkX, chunkY, tiles.size());
+                    continue;
+                }
+
+                for (uint32_t i = 0; i < chunkSize * chunkSize; i++) {
+                    const uint16_t tile = (uint16_t)(tiles.data()[i * 2] | (tiles.data()[i * 2 + 1] << 8));
+                    if (tile != 0)
+                        tc.setTile(chunkX * chunkSize + i % chunkSize, chunkY * chunkSize + i / chunkSize, tile - 1);
+                }
+            }
+        }
+
         return deserializedEntity;
     }
 }
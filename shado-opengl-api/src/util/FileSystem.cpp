@@ -3,6 +3,19 @@
 
 #include "debug/Debug.h"
 
+#if defined(SHADO_PLATFORM_WINDOWS)
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <Windows.h>
+    #undef DeleteFile
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
 namespace Shado {
     Buffer FileSystem::ReadFileBinary(const std::filesystem::path& filepath) {
         std::ifstream stream(filepath, std::ios::binary | std::ios::ate);
@@ -45,4 +58,67 @@ namespace Shado {
             std::filesystem::remove(path);
         }
     }
+
+    MappedFile::MappedFile(const std::filesystem::path& path) {
+#if defined(SHADO_PLATFORM_WINDOWS)
+        HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                  FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            return;
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+            CloseHandle(file);
+            return;
+        }
+
+        HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping) {
+            CloseHandle(file);
+            return;
+        }
+
+        m_Data = (const uint8_t*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (!m_Data) {
+            CloseHandle(mapping);
+            CloseHandle(file);
+            return;
+        }
+
+        m_Size = (uint64_t)size.QuadPart;
+        m_File = file;
+        m_Mapping = mapping;
+#else
+        int file = open(path.c_str(), O_RDONLY);
+        if (file < 0)
+            return;
+
+        struct stat info;
+        if (fstat(file, &info) != 0 || info.st_size == 0) {
+            close(file);
+            return;
+        }
+
+        void* data = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+        close(file); // The mapping keeps the file alive
+        if (data == MAP_FAILED)
+            return;
+
+        m_Data = (const uint8_t*)data;
+        m_Size = (uint64_t)info.st_size;
+#endif
+    }
+
+    MappedFile::~MappedFile() {
+        if (!m_Data)
+            return;
+
+#if defined(SHADO_PLATFORM_WINDOWS)
+        UnmapViewOfFile(m_Data);
+        CloseHandle(m_Mapping);
+        CloseHandle(m_File);
+#else
+        munmap((void*)m_Data, m_Size);
+#endif
+    }
 }
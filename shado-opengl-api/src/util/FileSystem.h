@@ -16,4 +16,26 @@ namespace Shado {
 
         static void DeleteFile(const std::filesystem::path& path);
     };
+
+    /**
+     * Read-only memory mapping of a whole file. The view stays valid for the lifetime of the object
+     */
+    class MappedFile {
+    public:
+        MappedFile(const std::filesystem::path& path);
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        const uint8_t* getData() const { return m_Data; }
+        uint64_t getSize() const { return m_Size; }
+        bool isValid() const { return m_Data != nullptr; }
+
+    private:
+        const uint8_t* m_Data = nullptr;
+        uint64_t m_Size = 0;
+        void* m_File = nullptr; // Platform handles
+        void* m_Mapping = nullptr;
+    };
 }